@@ -0,0 +1,96 @@
+#include "animation.hpp"
+#include <iostream>
+
+using namespace std;
+using namespace sf;
+
+bool SpriteSheet::loadFromFiles(const vector<string>& paths) {
+    vector<Image> images(paths.size());
+    unsigned width = 0;
+    unsigned height = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!images[i].loadFromFile(paths[i])) {
+            cerr << "Failed to load sprite sheet frame " << paths[i] << endl;
+            return false;
+        }
+        width += images[i].getSize().x;
+        height = max(height, images[i].getSize().y);
+    }
+
+    Image atlas;
+    atlas.create(width, height, Color::Transparent);
+    frames.clear();
+    unsigned x = 0;
+    for (const Image& image : images) {
+        atlas.copy(image, x, 0);
+        frames.push_back(IntRect(x, 0, image.getSize().x, image.getSize().y));
+        x += image.getSize().x;
+    }
+    return texture.loadFromImage(atlas);
+}
+
+IntRect SpriteSheet::getFrame(size_t index, bool flipped) const {
+    return flipped ? mirrored(frames[index]) : frames[index];
+}
+
+AnimationClip SpriteSheet::makeClip(size_t first, size_t count, float frameTime, bool loop) const {
+    AnimationClip clip;
+    clip.frames.assign(frames.begin() + first, frames.begin() + first + count);
+    clip.frameTime = frameTime;
+    clip.loop = loop;
+    return clip;
+}
+
+size_t Animator::play(const AnimationClip& clip) {
+    size_t handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = clips.size();
+        clips.push_back(nullptr);
+        timers.push_back(0.0f);
+        frames.push_back(0);
+        finished.push_back(0);
+        rects.push_back(IntRect());
+    }
+    restart(handle, clip);
+    return handle;
+}
+
+void Animator::restart(size_t handle, const AnimationClip& clip) {
+    clips[handle] = &clip;
+    timers[handle] = 0.0f;
+    frames[handle] = 0;
+    finished[handle] = 0;
+    rects[handle] = clip.frames[0];
+}
+
+void Animator::release(size_t handle) {
+    // Parking a released slot as finished keeps update() from touching it.
+    clips[handle] = nullptr;
+    finished[handle] = 1;
+    freeHandles.push_back(handle);
+}
+
+void Animator::update(float deltaTime) {
+    for (size_t i = 0; i < clips.size(); i++) {
+        if (finished[i]) continue;
+
+        const AnimationClip& clip = *clips[i];
+        timers[i] += deltaTime;
+        if (timers[i] < clip.frameTime) continue;
+        timers[i] = 0.0f;
+
+        size_t next = frames[i] + 1;
+        if (next >= clip.frames.size()) {
+            if (!clip.loop) {
+                finished[i] = 1;
+                continue;
+            }
+            next = 0;
+        }
+        frames[i] = static_cast<Uint16>(next);
+        rects[i] = clip.frames[next];
+    }
+}
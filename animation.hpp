@@ -0,0 +1,65 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace sf;
+
+inline IntRect mirrored(IntRect frame) {
+    frame.left += frame.width;
+    frame.width = -frame.width;
+    return frame;
+}
+
+struct AnimationClip;
+
+// A set of animation frames packed side by side into a single texture.
+// Entities share one sheet and pick frames by index; mirrored frames come
+// from flipping the texture rect, so no second copy is uploaded.
+class SpriteSheet {
+public:
+    bool loadFromFiles(const vector<string>& paths);
+    const Texture& getTexture() const { return texture; }
+    IntRect getFrame(size_t index, bool flipped = false) const;
+    size_t getFrameCount() const { return frames.size(); }
+    AnimationClip makeClip(size_t first, size_t count, float frameTime, bool loop) const;
+
+private:
+    Texture texture;
+    vector<IntRect> frames;
+};
+
+// A flipbook: the atlas rects to show in order and how long each one stays up.
+struct AnimationClip {
+    vector<IntRect> frames;
+    float frameTime = 0.1f;
+    bool loop = true;
+};
+
+// Owns the playback state of every running animation in contiguous arrays and
+// advances all of them in one pass per frame. Entities keep a handle and read
+// back the current atlas rect when they draw.
+class Animator {
+public:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    size_t play(const AnimationClip& clip);
+    // Rewinds an existing handle onto a (possibly different) clip.
+    void restart(size_t handle, const AnimationClip& clip);
+    void release(size_t handle);
+    void update(float deltaTime);
+
+    const IntRect& getRect(size_t handle) const { return rects[handle]; }
+    size_t getFrame(size_t handle) const { return frames[handle]; }
+    bool isFinished(size_t handle) const { return finished[handle] != 0; }
+    size_t getActiveCount() const { return clips.size() - freeHandles.size(); }
+
+private:
+    vector<const AnimationClip*> clips;
+    vector<float> timers;
+    vector<Uint16> frames;
+    vector<Uint8> finished;
+    vector<IntRect> rects;
+    vector<size_t> freeHandles;
+};
@@ -0,0 +1,60 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+using namespace std;
+
+FrameArena::FrameArena(size_t chunkSize) : chunkSize(chunkSize) {
+    addChunk(chunkSize);
+}
+
+void FrameArena::addChunk(size_t size) {
+    chunks.push_back({make_unique<char[]>(size), size});
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    while (true) {
+        Chunk& chunk = chunks[currentChunk];
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (start + size <= chunk.size) {
+            offset = start + size;
+            used += size;
+            return chunk.data.get() + start;
+        }
+        if (currentChunk + 1 == chunks.size()) {
+            addChunk(max(chunkSize, size + alignment));
+        }
+        currentChunk++;
+        offset = 0;
+    }
+}
+
+const char* FrameArena::format(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    va_list sizeArgs;
+    va_copy(sizeArgs, args);
+    int length = vsnprintf(nullptr, 0, fmt, sizeArgs);
+    va_end(sizeArgs);
+
+    char* buffer = allocateArray<char>(max(length, 0) + 1);
+    vsnprintf(buffer, max(length, 0) + 1, fmt, args);
+    va_end(args);
+    return buffer;
+}
+
+void FrameArena::reset() {
+    peak = max(peak, used);
+    currentChunk = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t FrameArena::getCapacity() const {
+    size_t capacity = 0;
+    for (const Chunk& chunk : chunks) {
+        capacity += chunk.size;
+    }
+    return capacity;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Bump allocator for data that only lives for one tick. Chunks are kept
+// across reset(), so once the arena has grown to fit the busiest tick it no
+// longer touches the heap.
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit FrameArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+    template<typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    // printf-style formatting into arena memory; valid until the next reset().
+    const char* format(const char* fmt, ...);
+    void reset();
+
+    size_t getUsed() const { return used; }
+    size_t getPeak() const { return peak; }
+    size_t getCapacity() const;
+
+private:
+    struct Chunk {
+        unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    size_t chunkSize;
+    vector<Chunk> chunks;
+    size_t currentChunk = 0;
+    size_t offset = 0;
+    size_t used = 0;
+    size_t peak = 0;
+
+    void addChunk(size_t size);
+};
+
+// Lets standard containers live in a FrameArena. Deallocation is a no-op;
+// the memory comes back when the arena is reset.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena& arena) : arena(&arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->allocateArray<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template<typename U> friend class ArenaAllocator;
+    FrameArena* arena;
+};
+
+template<typename T>
+using ArenaVector = vector<T, ArenaAllocator<T>>;
+
+// Gives a class its own operator new/delete backed by a free list of blocks
+// its size. Deleted objects leave their block on the list for the next new,
+// so a steady churn of spawns and removals stops reaching the heap once the
+// list has grown to fit the busiest moment. The list is per thread, so
+// worlds running on batch workers never share one; blocks still on it are
+// freed when the thread exits.
+template<typename T>
+class FreeListAllocated {
+public:
+    static void* operator new(size_t size) {
+        FreeList& list = freeList();
+        // Subclasses of different size fall through to the heap.
+        if (size != sizeof(T) || list.head == nullptr) {
+            return ::operator new(size);
+        }
+        Block* block = list.head;
+        list.head = block->next;
+        list.count--;
+        return block;
+    }
+
+    static void operator delete(void* pointer, size_t size) {
+        if (pointer == nullptr) return;
+        if (size != sizeof(T)) {
+            ::operator delete(pointer);
+            return;
+        }
+        FreeList& list = freeList();
+        Block* block = static_cast<Block*>(pointer);
+        block->next = list.head;
+        list.head = block;
+        list.count++;
+    }
+
+    // Tops the calling thread's list up to `count` blocks, so the first busy
+    // stretch does not grow it one allocation at a time.
+    static void reserve(size_t count) {
+        FreeList& list = freeList();
+        while (list.count < count) {
+            Block* block = static_cast<Block*>(::operator new(sizeof(T)));
+            block->next = list.head;
+            list.head = block;
+            list.count++;
+        }
+    }
+
+    // Blocks waiting for reuse on the calling thread.
+    static size_t getFreeCount() { return freeList().count; }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    struct FreeList {
+        Block* head = nullptr;
+        size_t count = 0;
+
+        ~FreeList() {
+            while (head != nullptr) {
+                Block* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    };
+
+    static FreeList& freeList() {
+        thread_local FreeList list;
+        return list;
+    }
+};
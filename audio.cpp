@@ -0,0 +1,57 @@
+#include "audio.hpp"
+
+using namespace std;
+using namespace sf;
+
+AudioThread::~AudioThread() {
+    shutdown();
+}
+
+void AudioThread::setBuffer(SoundId sound, const SoundBuffer& buffer) {
+    voices[static_cast<size_t>(sound)].setBuffer(buffer);
+}
+
+void AudioThread::start() {
+    running = true;
+    worker = thread(&AudioThread::run, this);
+}
+
+void AudioThread::shutdown() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AudioThread::send(const AudioCommand& command) {
+    // A full queue means the audio thread is stalled; losing a sound effect
+    // is better than blocking the tick.
+    if (!commands.push(command)) {
+        dropped++;
+    }
+}
+
+void AudioThread::run() {
+    while (running) {
+        AudioCommand command;
+        bool idle = true;
+        while (commands.pop(command)) {
+            idle = false;
+            Sound& voice = voices[static_cast<size_t>(command.sound)];
+            switch (command.type) {
+                case AudioCommand::Type::Play:
+                    voice.play();
+                    break;
+                case AudioCommand::Type::Stop:
+                    voice.stop();
+                    break;
+                case AudioCommand::Type::SetVolume:
+                    voice.setVolume(command.volume);
+                    break;
+            }
+        }
+        if (idle) {
+            sleep(milliseconds(IDLE_SLEEP_MS));
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+using namespace std;
+using namespace sf;
+
+// Lock-free queue for exactly one producer thread and one consumer thread.
+template<typename T, size_t N>
+class SpscQueue {
+public:
+    static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+
+    bool push(const T& item) {
+        size_t tail = tailIndex.load(memory_order_relaxed);
+        if (tail - headIndex.load(memory_order_acquire) == N) {
+            return false;
+        }
+        items[tail & (N - 1)] = item;
+        tailIndex.store(tail + 1, memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = headIndex.load(memory_order_relaxed);
+        if (head == tailIndex.load(memory_order_acquire)) {
+            return false;
+        }
+        item = items[head & (N - 1)];
+        headIndex.store(head + 1, memory_order_release);
+        return true;
+    }
+
+private:
+    array<T, N> items;
+    // Kept on separate cache lines so the two threads do not false-share.
+    alignas(64) atomic<size_t> headIndex{0};
+    alignas(64) atomic<size_t> tailIndex{0};
+};
+
+enum class SoundId : Uint8 {
+    Shoot,
+    PlayerDeath,
+    PowerUp,
+    EnemyDeath,
+    EnemyShoot,
+    FullPower,
+    Extend
+};
+
+const size_t SOUND_COUNT = 7;
+
+struct AudioCommand {
+    enum class Type : Uint8 {
+        Play,
+        Stop,
+        SetVolume
+    };
+
+    Type type;
+    SoundId sound;
+    float volume = 100.0f;
+};
+
+// Owns every sound effect voice and drives them from its own thread. The
+// game thread only pushes commands, so it never waits on the audio device.
+class AudioThread {
+public:
+    static constexpr size_t QUEUE_SIZE = 256;
+    static constexpr int IDLE_SLEEP_MS = 1;
+
+    AudioThread() = default;
+    ~AudioThread();
+
+    // Buffers must be assigned before start() and outlive the thread.
+    void setBuffer(SoundId sound, const SoundBuffer& buffer);
+    void start();
+    void shutdown();
+
+    void play(SoundId sound) { send({AudioCommand::Type::Play, sound}); }
+    void stop(SoundId sound) { send({AudioCommand::Type::Stop, sound}); }
+    void setVolume(SoundId sound, float volume) { send({AudioCommand::Type::SetVolume, sound, volume}); }
+
+    size_t getDroppedCommands() const { return dropped; }
+
+private:
+    SpscQueue<AudioCommand, QUEUE_SIZE> commands;
+    array<Sound, SOUND_COUNT> voices;
+    atomic<bool> running{false};
+    thread worker;
+    size_t dropped = 0;
+
+    void send(const AudioCommand& command);
+    void run();
+};
@@ -0,0 +1,210 @@
+#include "batch.hpp"
+#include "bot.hpp"
+#include "memory.hpp"
+#include "replay.hpp"
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace sf;
+
+BatchRunner::BatchRunner(const PlayField& field, float deltaTime)
+    : field(field), deltaTime(deltaTime) {}
+
+bool BatchRunner::loadFromFile(const string& path) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Error opening batch file: " << path << endl;
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        istringstream fields(line);
+        string kind;
+        fields >> kind;
+        BatchJob job;
+        if (kind == "replay") {
+            job.kind = BatchJob::Kind::Replay;
+            if (!(fields >> job.replayPath)) {
+                cerr << path << ":" << lineNumber << ": expected 'replay <path> [max ticks]'" << endl;
+                return false;
+            }
+            fields >> job.maxTicks;
+        } else if (kind == "bot") {
+            job.kind = BatchJob::Kind::Bot;
+            if (!(fields >> job.seed)) {
+                cerr << path << ":" << lineNumber << ": expected 'bot <seed> [max ticks] [players]'" << endl;
+                return false;
+            }
+            if (fields >> job.maxTicks) {
+                fields >> job.players;
+            }
+            if (job.players < 1 || job.players > MAX_PLAYERS) {
+                cerr << path << ":" << lineNumber << ": players must be 1 or 2" << endl;
+                return false;
+            }
+        } else if (!kind.empty()) {
+            cerr << path << ":" << lineNumber << ": unknown job '" << kind << "'" << endl;
+            return false;
+        }
+        if (!kind.empty()) {
+            jobs.push_back(job);
+        }
+    }
+    if (jobs.empty()) {
+        cerr << path << ": no jobs" << endl;
+        return false;
+    }
+    return true;
+}
+
+void BatchRunner::run(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    threadsUsed = max<size_t>(1, min(threadCount, jobs.size()));
+    results.assign(jobs.size(), BatchResult());
+
+    Clock clock;
+    // Jobs are handed out one at a time, so a long game does not hold up
+    // the short ones queued behind it on the same thread.
+    atomic<size_t> nextJob(0);
+    auto work = [&] {
+        MemoryScope scope(MemoryTag::Entities);
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            try {
+                runJob(jobs[i], results[i]);
+            } catch (const exception& error) {
+                results[i].passed = false;
+                results[i].error = error.what();
+            }
+        }
+    };
+    vector<thread> workers;
+    for (size_t i = 1; i < threadsUsed; i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    wallSeconds = clock.getElapsedTime().asSeconds();
+}
+
+void BatchRunner::runJob(const BatchJob& job, BatchResult& result) const {
+    Animator animator;
+    FrameArena arena;
+    Clock clock;
+
+    if (job.kind == BatchJob::Kind::Replay) {
+        Replay replay;
+        if (!replay.loadFromFile(job.replayPath)) {
+            result.error = "could not load replay";
+            return;
+        }
+        World world(field, animator);
+        if (!replay.seek(world, 0, arena)) {
+            result.error = "replay has no starting keyframe";
+            return;
+        }
+        Uint32 end = replay.getTickCount();
+        if (job.maxTicks > 0) {
+            end = min(end, job.maxTicks);
+        }
+        clock.restart();
+        while (world.getTick() < end) {
+            replay.verify(world);
+            const Replay::Frame& frame = replay.getFrame(world.getTick());
+            world.step(frame.inputs, frame.deltaTime, arena);
+            arena.reset();
+        }
+        result.seconds = clock.getElapsedTime().asSeconds();
+        result.verifiedTicks = replay.getVerifiedTicks();
+        result.mismatches = replay.getMismatchCount();
+        result.passed = result.mismatches == 0;
+        for (size_t i = 0; i < world.getPlayerCount(); i++) {
+            result.score += world.getPlayer(i).getScore();
+        }
+        result.ticks = world.getTick();
+        result.finalChecksum = hashValue(HASH_SEED, world.checksum().parts);
+        return;
+    }
+
+    World world(field, animator, job.players, job.seed);
+    world.reset();
+    vector<Autopilot> pilots(world.getPlayerCount());
+    Uint32 end = job.maxTicks > 0 ? job.maxTicks : DEFAULT_BOT_TICKS;
+    while (world.getTick() < end && !world.isGameOver()) {
+        PlayerInputs inputs = {};
+        for (size_t i = 0; i < pilots.size(); i++) {
+            inputs[i] = pilots[i].think(world, i);
+        }
+        world.step(inputs, deltaTime, arena);
+        arena.reset();
+    }
+    result.seconds = clock.getElapsedTime().asSeconds();
+    result.passed = true;
+    for (size_t i = 0; i < world.getPlayerCount(); i++) {
+        result.score += world.getPlayer(i).getScore();
+    }
+    result.ticks = world.getTick();
+    result.finalChecksum = hashValue(HASH_SEED, world.checksum().parts);
+}
+
+bool BatchRunner::allPassed() const {
+    for (const BatchResult& result : results) {
+        if (!result.passed) {
+            return false;
+        }
+    }
+    return !results.empty();
+}
+
+void BatchRunner::print(ostream& out) const {
+    Uint64 totalTicks = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BatchJob& job = jobs[i];
+        const BatchResult& result = results[i];
+        out << "batch: [" << i << "] ";
+        if (job.kind == BatchJob::Kind::Replay) {
+            out << "replay " << job.replayPath;
+        } else {
+            out << "bot " << job.seed;
+        }
+        if (!result.error.empty()) {
+            out << ": FAILED, " << result.error << endl;
+            failed++;
+            continue;
+        }
+        double ticksPerSecond = result.seconds > 0.0 ? result.ticks / result.seconds : 0.0;
+        out << ": " << result.ticks << " ticks, score " << result.score
+            << ", " << fixed << setprecision(0) << ticksPerSecond << " ticks/s"
+            << ", checksum " << hex << setw(8) << setfill('0') << result.finalChecksum
+            << dec << setfill(' ');
+        if (job.kind == BatchJob::Kind::Replay) {
+            out << ", " << result.verifiedTicks << " matched, " << result.mismatches << " diverged";
+        }
+        out << endl;
+        totalTicks += result.ticks;
+        if (!result.passed) {
+            failed++;
+        }
+    }
+    double ticksPerSecond = wallSeconds > 0.0 ? totalTicks / wallSeconds : 0.0;
+    out << "batch: " << results.size() << " runs on " << threadsUsed << " threads in "
+        << fixed << setprecision(3) << wallSeconds << " s, " << totalTicks << " ticks, "
+        << setprecision(0) << ticksPerSecond << " ticks/s overall, " << failed << " failed" << endl;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <SFML/Config.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "world.hpp"
+
+using namespace std;
+using namespace sf;
+
+// One headless game: either a replay played back and checked against its
+// recorded checksums, or a seeded game flown by the autopilot.
+struct BatchJob {
+    enum class Kind {
+        Replay,
+        Bot
+    };
+
+    Kind kind = Kind::Bot;
+    string replayPath;
+    Uint64 seed = World::DEFAULT_SEED;
+    size_t players = 1;
+    // Stops the run early; 0 plays a replay to its end and a bot game for
+    // DEFAULT_BOT_TICKS or until game over.
+    Uint32 maxTicks = 0;
+};
+
+struct BatchResult {
+    // Ran to the end and, for a replay, matched every recorded checksum.
+    bool passed = false;
+    string error;
+    Int64 score = 0;
+    Uint32 ticks = 0;
+    double seconds = 0.0;
+    Uint32 verifiedTicks = 0;
+    Uint32 mismatches = 0;
+    // The world checksum after the last tick, folded into one value, so two
+    // batches of the same jobs can be compared line by line.
+    Uint32 finalChecksum = 0;
+};
+
+// Runs many independent games at once, one per worker thread. Every worker
+// owns its World, Animator and FrameArena; the only thing the games share is
+// the entity art, which is loaded up front and only read afterwards.
+class BatchRunner {
+public:
+    static const Uint32 DEFAULT_BOT_TICKS = 60 * 60 * 10;
+
+    // Bot games step by deltaTime; replays use the steps they recorded.
+    explicit BatchRunner(const PlayField& field, float deltaTime);
+
+    // One job per line, blank lines and '#' comments skipped:
+    //   replay <path> [max ticks]
+    //   bot <seed> [max ticks] [players]
+    bool loadFromFile(const string& path);
+    void addJob(const BatchJob& job) { jobs.push_back(job); }
+    size_t getJobCount() const { return jobs.size(); }
+
+    // Blocks until every job has run. threadCount 0 uses every core.
+    void run(size_t threadCount);
+
+    const vector<BatchResult>& getResults() const { return results; }
+    bool allPassed() const;
+    // One line per job, then the totals.
+    void print(ostream& out) const;
+
+private:
+    PlayField field;
+    float deltaTime;
+    vector<BatchJob> jobs;
+    vector<BatchResult> results;
+    size_t threadsUsed = 0;
+    double wallSeconds = 0.0;
+
+    void runJob(const BatchJob& job, BatchResult& result) const;
+};
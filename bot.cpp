@@ -0,0 +1,148 @@
+#include "bot.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace sf;
+
+namespace {
+
+struct Move {
+    int dx;
+    int dy;
+};
+
+const Move MOVES[] = {
+    {0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1},
+    {-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+}
+
+void Autopilot::gatherThreats(const World& world, const Vector2f& center, float range) {
+    threats.clear();
+    auto nearby = [&](const Vector2f& pos, const Vector2f& halfSize) {
+        return abs(pos.x - center.x) <= range + halfSize.x && abs(pos.y - center.y) <= range + halfSize.y;
+    };
+    for (const auto& bullet : world.getEnemyBullets()) {
+        Vector2f pos = bullet->getPosition();
+        if (bullet->isActive() && nearby(pos, Vector2f())) {
+            threats.push_back({pos, bullet->getVelocity(), Vector2f(), EnemyBullet::HIT_RADIUS});
+        }
+    }
+    const Vector2f enemyHalf(Enemy::HIT_HALF_WIDTH, Enemy::HIT_HALF_HEIGHT);
+    for (const auto& enemy : world.getEnemies()) {
+        Vector2f pos = enemy->getPosition();
+        if (enemy->isActive() && nearby(pos, enemyHalf)) {
+            threats.push_back({pos, enemy->getVelocity(), enemyHalf, 0.0f});
+        }
+    }
+    const Vector2f carHalf(Car::HIT_HALF_WIDTH, Car::HIT_HALF_HEIGHT);
+    for (const auto& car : world.getCars()) {
+        Vector2f pos = car->getPosition();
+        if (car->isActive() && nearby(pos, carHalf)) {
+            threats.push_back({pos, car->getVelocity(), carHalf, 0.0f});
+        }
+    }
+    for (const auto& boss : world.getBosses()) {
+        for (size_t i = 0; i < boss->getPartCount(); i++) {
+            HitBox box = boss->getPartHitBox(i);
+            if (boss->isPartAlive(i) && nearby(box.center, box.halfSize)) {
+                threats.push_back({box.center, boss->getVelocity(), box.halfSize, 0.0f});
+            }
+        }
+    }
+}
+
+// Distance between the ship's hit circle at position and the nearest threat
+// extrapolated by time; negative when they overlap.
+float Autopilot::clearance(const Vector2f& position, float time) const {
+    float nearest = SAFE_CLEARANCE;
+    for (const Threat& threat : threats) {
+        Vector2f center = threat.position + threat.velocity * time;
+        float dx = max(abs(position.x - center.x) - threat.halfSize.x, 0.0f);
+        float dy = max(abs(position.y - center.y) - threat.halfSize.y, 0.0f);
+        float gap = sqrt(dx * dx + dy * dy) - threat.radius - Player::HIT_RADIUS;
+        nearest = min(nearest, gap);
+    }
+    return nearest;
+}
+
+InputState Autopilot::think(const World& world, size_t playerIndex) {
+    InputState input;
+    const Player& player = world.getPlayer(playerIndex);
+    if (player.getLives() <= 0) {
+        bombHeld = false;
+        return input;
+    }
+    const PlayField& field = world.getField();
+    Vector2f position = player.getPosition();
+
+    gatherThreats(world, position, SCAN_RADIUS);
+
+    // Line up under the lowest enemy still above the ship.
+    float targetX = field.left() + field.bounds.width / 2;
+    float lowestY = field.top() - PlayField::CULL_MARGIN;
+    for (const auto& enemy : world.getEnemies()) {
+        Vector2f pos = enemy->getPosition();
+        if (enemy->isActive() && pos.y < position.y && pos.y > lowestY) {
+            lowestY = pos.y;
+            targetX = pos.x;
+        }
+    }
+    for (const auto& boss : world.getBosses()) {
+        Vector2f pos = boss->getPartPosition(Boss::CORE);
+        if (boss->isActive() && pos.y < position.y && pos.y > lowestY) {
+            lowestY = pos.y;
+            targetX = pos.x;
+        }
+    }
+    const float homeY = field.bottom() - HOME_HEIGHT;
+    // The ship is clamped at the edges, so moves into them go nowhere.
+    auto clampToField = [&](Vector2f pos) {
+        pos.x = max(field.left(), min(pos.x, field.right()));
+        pos.y = max(field.top(), min(pos.y, field.bottom()));
+        return pos;
+    };
+
+    float bestScore = -1e9f;
+    float bestClearance = -1e9f;
+    size_t bestMove = 0;
+    bool bestFocused = false;
+    for (int focused = 0; focused < 2; focused++) {
+        float speed = focused ? Player::FOCUSED_SPEED : Player::NORMAL_SPEED;
+        for (size_t m = 0; m < sizeof(MOVES) / sizeof(MOVES[0]); m++) {
+            Vector2f direction(static_cast<float>(MOVES[m].dx), static_cast<float>(MOVES[m].dy));
+            Vector2f halfway = clampToField(position + direction * (speed * LOOKAHEAD * 0.5f));
+            Vector2f end = clampToField(position + direction * (speed * LOOKAHEAD));
+
+            float safety = min(clearance(halfway, LOOKAHEAD * 0.5f), clearance(end, LOOKAHEAD));
+            float score = safety
+                - abs(end.x - targetX) * 0.05f
+                - abs(end.y - homeY) * 0.02f;
+            if (score > bestScore) {
+                bestScore = score;
+                bestClearance = safety;
+                bestMove = m;
+                bestFocused = focused != 0;
+            }
+        }
+    }
+
+    input.set(InputState::Left, MOVES[bestMove].dx < 0);
+    input.set(InputState::Right, MOVES[bestMove].dx > 0);
+    input.set(InputState::Up, MOVES[bestMove].dy < 0);
+    input.set(InputState::Down, MOVES[bestMove].dy > 0);
+    input.set(InputState::Focus, bestFocused);
+    input.set(InputState::Shoot, true);
+
+    // Bombs fire on the press, so release for a tick after each one.
+    bool bomb = !bombHeld && bestClearance < BOMB_CLEARANCE &&
+                !player.isInvincible() && player.getBombs() > 0;
+    input.set(InputState::Bomb, bomb);
+    bombHeld = bomb;
+    if (bomb) {
+        bombsUsed++;
+    }
+    return input;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "input.hpp"
+#include "world.hpp"
+
+using namespace std;
+using namespace sf;
+
+// Flies a ship from what is on screen and answers with the same buttons the
+// keyboard would press. Each tick it tries every direction at both speeds,
+// extrapolates nearby threats a short way ahead, and takes the move that
+// keeps the most clearance, preferring to sit under the closest enemy.
+// Deterministic, so a bot run replays like any other.
+class Autopilot {
+public:
+    // How far ahead threats and moves are extrapolated.
+    static constexpr float LOOKAHEAD = 0.2f;
+    // Threats further than this from the ship are ignored.
+    static constexpr float SCAN_RADIUS = 160.0f;
+    // Clearance beyond this is all equally safe, so aiming decides.
+    static constexpr float SAFE_CLEARANCE = 24.0f;
+    // When even the best move leaves less than this, a bomb is used.
+    static constexpr float BOMB_CLEARANCE = 1.0f;
+    // Where the ship rests when nothing needs dodging, above the bottom edge.
+    static constexpr float HOME_HEIGHT = 80.0f;
+
+    InputState think(const World& world, size_t playerIndex);
+
+    size_t getBombsUsed() const { return bombsUsed; }
+
+private:
+    struct Threat {
+        Vector2f position;
+        Vector2f velocity;
+        // Circles have a radius and no extent; boxes the other way round.
+        Vector2f halfSize;
+        float radius;
+    };
+
+    // Reused every tick so thinking does not allocate once warmed up.
+    vector<Threat> threats;
+    bool bombHeld = false;
+    size_t bombsUsed = 0;
+
+    void gatherThreats(const World& world, const Vector2f& center, float range);
+    float clearance(const Vector2f& position, float time) const;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <SFML/Config.hpp>
+#include <cstddef>
+
+using namespace sf;
+
+// 32-bit FNV-1a. Chain calls by passing the previous result as the hash.
+const Uint32 HASH_SEED = 2166136261u;
+
+inline Uint32 hashBytes(Uint32 hash, const void* data, size_t size) {
+    const Uint8* bytes = static_cast<const Uint8*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template<typename T>
+Uint32 hashValue(Uint32 hash, const T& value) {
+    return hashBytes(hash, &value, sizeof(T));
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace sf;
+
+// Hit shapes are plain centre/extent data built straight from an entity's
+// position, so tests never go through a sprite's transform.
+struct HitCircle {
+    Vector2f center;
+    float radius;
+};
+
+struct HitBox {
+    Vector2f center;
+    Vector2f halfSize;
+};
+
+// The overlap tests combine their axis checks with '&' and min/max rather
+// than early-outs so they compile to straight-line code. sweptOverlaps is the
+// exception: a segment parallel to a slab has to be rejected separately.
+inline bool overlaps(const HitCircle& a, const HitCircle& b) {
+    float dx = a.center.x - b.center.x;
+    float dy = a.center.y - b.center.y;
+    float radii = a.radius + b.radius;
+    return dx * dx + dy * dy <= radii * radii;
+}
+
+inline bool overlaps(const HitCircle& circle, const HitBox& box) {
+    float dx = max(fabs(circle.center.x - box.center.x) - box.halfSize.x, 0.0f);
+    float dy = max(fabs(circle.center.y - box.center.y) - box.halfSize.y, 0.0f);
+    return dx * dx + dy * dy <= circle.radius * circle.radius;
+}
+
+inline bool overlaps(const HitBox& a, const HitBox& b) {
+    return (fabs(a.center.x - b.center.x) <= a.halfSize.x + b.halfSize.x) &
+           (fabs(a.center.y - b.center.y) <= a.halfSize.y + b.halfSize.y);
+}
+
+// Swept test of a box moving from `from` to `to` against a static box. The
+// target is grown by the moving box's half size so the mover reduces to a
+// point, then the segment is clipped against both slabs.
+inline bool sweptOverlaps(const Vector2f& from, const Vector2f& to, const Vector2f& halfSize, const HitBox& target) {
+    const float minX = target.center.x - target.halfSize.x - halfSize.x;
+    const float maxX = target.center.x + target.halfSize.x + halfSize.x;
+    const float minY = target.center.y - target.halfSize.y - halfSize.y;
+    const float maxY = target.center.y + target.halfSize.y + halfSize.y;
+    const Vector2f delta = to - from;
+
+    float tEnter = 0.0f;
+    float tExit = 1.0f;
+    if (delta.x == 0.0f) {
+        if (from.x < minX || from.x > maxX) return false;
+    } else {
+        float t1 = (minX - from.x) / delta.x;
+        float t2 = (maxX - from.x) / delta.x;
+        tEnter = max(tEnter, min(t1, t2));
+        tExit = min(tExit, max(t1, t2));
+    }
+    if (delta.y == 0.0f) {
+        if (from.y < minY || from.y > maxY) return false;
+    } else {
+        float t1 = (minY - from.y) / delta.y;
+        float t2 = (maxY - from.y) / delta.y;
+        tEnter = max(tEnter, min(t1, t2));
+        tExit = min(tExit, max(t1, t2));
+    }
+    return tEnter <= tExit;
+}
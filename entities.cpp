@@ -1,4 +1,5 @@
 #include "entities.hpp"
+#include "memory.hpp"
 #include <iostream>
 
 using namespace std;
@@ -7,23 +8,35 @@ using namespace sf;
 const int Player::MAX_POWER = 10; 
 const float Player::SIDE_VIEW_WIDTH_SCALE = 1.5f;  
 Texture Bullet::bulletTexture;
+once_flag Bullet::textureOnce;
 Texture EnemyBullet::bulletTexture;
-bool EnemyBullet::textureLoaded = false;
+once_flag EnemyBullet::textureOnce;
 Texture Car::carTexture;
-bool Car::textureLoaded = false;
-vector<Texture> PowerUp::powerUpTextures;
-bool PowerUp::texturesLoaded = false;
-vector<Texture> Entity::deathTextures;
-bool Entity::deathTexturesLoaded = false;
+once_flag Car::textureOnce;
+SpriteSheet PowerUpPool::powerUpSheet;
+AnimationClip PowerUpPool::spinClip;
+once_flag PowerUpPool::texturesOnce;
+SpriteSheet Player::sheet;
+AnimationClip Player::sideClip;
+once_flag Player::sheetOnce;
+SpriteSheet Entity::deathSheet;
+AnimationClip Entity::deathClip;
+once_flag Entity::deathTexturesOnce;
 Entity::Entity(const Vector2f& pos, const Vector2f& vel) 
     : position(pos), velocity(vel) {}
 
+Entity::~Entity() {
+    if (animator && deathAnim != Animator::NONE) {
+        animator->release(deathAnim);
+    }
+}
+
 void Entity::update(float deltaTime) {
     position += velocity * deltaTime;
     if (shape) shape->setPosition(position);
 }
 
-void Entity::draw(RenderWindow& window) {
+void Entity::draw(RenderTarget& window) {
     if (shape) window.draw(*shape);
 }
 
@@ -32,72 +45,92 @@ void Entity::setActive(bool state) { active = state; }
 Vector2f Entity::getPosition() const { return position; }
 
 void Entity::loadDeathTextures() {
-    if (!deathTexturesLoaded) {
-        deathTextures.resize(7);
+    call_once(deathTexturesOnce, [] {
+        vector<string> paths;
         for (int i = 0; i < 7; i++) {
-            if (!deathTextures[i].loadFromFile("assets/die/ex" + to_string(i + 1) + ".png")) {
-                cerr << "Failed to load ex" << (i + 1) << ".png" << endl;
-            }
+            paths.push_back("assets/die/ex" + to_string(i + 1) + ".png");
         }
-        deathTexturesLoaded = true;
-    }
+        if (!deathSheet.loadFromFiles(paths)) {
+            cerr << "Failed to load death animation frames" << endl;
+            return;
+        }
+        MemoryTracker::trackTexture(MemoryTag::Entities, deathSheet.getTexture());
+        deathClip = deathSheet.makeClip(0, 7, DEATH_FRAME_TIME, false);
+    });
 }
 
 void Entity::startDeathAnimation() {
+    startDeathAnimation(deathClip);
+}
+
+void Entity::startDeathAnimation(const AnimationClip& clip) {
     isDying = true;
-    deathAnimTimer = 0.0f;
-    currentDeathFrame = 0;
-    deathSprite.setTexture(deathTextures[0]);
+    if (deathAnim == Animator::NONE) {
+        deathAnim = animator->play(clip);
+    } else {
+        animator->restart(deathAnim, clip);
+    }
+    deathSprite.setTexture(deathSheet.getTexture());
+    deathSprite.setTextureRect(clip.frames[0]);
     deathSprite.setPosition(position);
-    FloatRect bounds = deathSprite.getLocalBounds();
-    deathSprite.setOrigin(bounds.width / 2.f, bounds.height / 2.f);
+    deathSprite.setOrigin(clip.frames[0].width / 2.f, clip.frames[0].height / 2.f);
 }
 
-void Entity::updateDeathAnimation(float deltaTime) {
-    if (!isDying) return;
-
-    deathAnimTimer += deltaTime;
-    const float flashingDuration = 1.0f; 
-    const float frameDuration = 0.1f;    
+EntityState Entity::getEntityState() const {
+    return {position, velocity, static_cast<Uint8>(active), static_cast<Uint8>(isDying), {0, 0}};
+}
 
-    if (currentDeathFrame < 7) {
-        if (deathAnimTimer >= DEATH_FRAME_TIME) {
-            deathAnimTimer = 0;
-            currentDeathFrame++;
-            if (currentDeathFrame < 7) {
-                deathSprite.setTexture(deathTextures[currentDeathFrame]);
-            }
-        }
+void Entity::setEntityState(const EntityState& state) {
+    position = state.position;
+    velocity = state.velocity;
+    active = state.active != 0;
+    if (state.isDying && !isDying) {
+        startDeathAnimation();
     }
+    isDying = state.isDying != 0;
 }
 
-void Entity::drawDeathAnimation(RenderWindow& window) {
-    if (isDying) {
+bool Entity::isInDeathAnimation() const {
+    return isDying && !animator->isFinished(deathAnim);
+}
+
+void Entity::drawDeathAnimation(RenderTarget& window) {
+    if (isInDeathAnimation()) {
+        deathSprite.setTextureRect(animator->getRect(deathAnim));
         window.draw(deathSprite); 
     }
 }
-Player::Player(const Vector2f& pos) 
-    : Entity(pos, Vector2f(0, 0)), isAtFullPower(false) {
-    if (!upTexture.loadFromFile("assets/chin/up.png") ||
-        !downTexture.loadFromFile("assets/chin/down.png")) {
-        throw runtime_error("Failed to load player textures");
-    }
-
-    for (int i = 1; i <= 4; i++) { 
-        Texture texture;
-        if (!texture.loadFromFile("assets/chin/right" + to_string(i) + ".png")) {
-            throw runtime_error("Failed to load right animation frame " + to_string(i));
+// A loader that throws leaves its once_flag unset, so the next entity retries.
+void Player::loadTextures() {
+    call_once(sheetOnce, [] {
+        vector<string> paths = {"assets/chin/up.png", "assets/chin/down.png"};
+        for (size_t i = 1; i <= SIDE_FRAME_COUNT; i++) {
+            paths.push_back("assets/chin/right" + to_string(i) + ".png");
         }
-        rightAnimFrames.push_back(texture);
-        Texture flippedTexture = texture;
-        leftAnimFrames.push_back(flippedTexture);
-    }
-    playerSprite.setTexture(upTexture);
+        if (!sheet.loadFromFiles(paths)) {
+            throw runtime_error("Failed to load player textures");
+        }
+        MemoryTracker::trackTexture(MemoryTag::Entities, sheet.getTexture());
+        sideClip = sheet.makeClip(FRAME_SIDE, SIDE_FRAME_COUNT, 0.1f, true);
+    });
+}
+
+Player::Player(const Vector2f& pos, const PlayField& field, Animator& animator) 
+    : Entity(pos, Vector2f(0, 0)), isAtFullPower(false), field(field) {
+    this->animator = &animator;
+    loadTextures();
+    sideAnim = animator.play(sideClip);
+    playerSprite.setTexture(sheet.getTexture());
+    playerSprite.setTextureRect(sheet.getFrame(FRAME_UP));
     playerSprite.setOrigin(playerSprite.getGlobalBounds().width / 2,
                           playerSprite.getGlobalBounds().height / 2);
     playerSprite.setPosition(position);
 }
-vector<PowerUp*> powerUps;  
+
+Player::~Player() {
+    animator->release(sideAnim);
+}
+
 void Player::update(float deltaTime) {
     if (currentCooldown > 0) {
         currentCooldown -= deltaTime;
@@ -105,75 +138,62 @@ void Player::update(float deltaTime) {
     if (currentInvincibilityTime > 0) {
         currentInvincibilityTime -= deltaTime;
     }
-    isFocused = Keyboard::isKeyPressed(Keyboard::LShift) || 
-                Keyboard::isKeyPressed(Keyboard::RShift);
+    isFocused = input.has(InputState::Focus);
     speed = isFocused ? focusedSpeed : normalSpeed;
 
     velocity = Vector2f(0, 0);
     bool isMoving = false;
-    animationTimer += deltaTime;
-    if (animationTimer >= FRAME_TIME) {
-        animationTimer = 0;
-        currentFrame = (currentFrame + 1) % leftAnimFrames.size();
-    }
+    bool sideways = false;
+    size_t frameIndex = wasMovingUp ? FRAME_UP : FRAME_DOWN;
     
-    if (Keyboard::isKeyPressed(Keyboard::Left)) {
+    if (input.has(InputState::Left)) {
         velocity.x = -speed;
-        playerSprite.setTexture(rightAnimFrames[currentFrame]);
-        playerSprite.setScale(-SIDE_VIEW_WIDTH_SCALE, 1.0f);  
+        facingLeft = true;
+        sideways = true;
         isMoving = true;
     }
-    if (Keyboard::isKeyPressed(Keyboard::Right)) {
+    if (input.has(InputState::Right)) {
         velocity.x = speed;
-        playerSprite.setTexture(rightAnimFrames[currentFrame]);
-        playerSprite.setScale(SIDE_VIEW_WIDTH_SCALE, 1.0f); 
+        facingLeft = false;
+        sideways = true;
         isMoving = true;
     }
-    if (Keyboard::isKeyPressed(Keyboard::Up)) {
+    if (input.has(InputState::Up)) {
         velocity.y = -speed;
-        playerSprite.setTexture(upTexture);
-        playerSprite.setScale(SIDE_VIEW_WIDTH_SCALE, 1.0f);  
+        frameIndex = FRAME_UP;
+        sideways = false;
         wasMovingUp = true;
         isMoving = true;
     }
-    if (Keyboard::isKeyPressed(Keyboard::Down)) {
+    if (input.has(InputState::Down)) {
         velocity.y = speed;
-        playerSprite.setTexture(downTexture);
-        playerSprite.setScale(SIDE_VIEW_WIDTH_SCALE, 1.0f); 
+        frameIndex = FRAME_DOWN;
+        sideways = false;
         wasMovingUp = false;
         isMoving = true;
     }
-    if (!isMoving) {
-        playerSprite.setTexture(wasMovingUp ? upTexture : downTexture);
+    if (isMoving) {
+        playerSprite.setScale(SIDE_VIEW_WIDTH_SCALE, 1.0f);
+    }
+    if (sideways) {
+        const IntRect& frame = animator->getRect(sideAnim);
+        playerSprite.setTextureRect(facingLeft ? mirrored(frame) : frame);
+    } else {
+        playerSprite.setTextureRect(sheet.getFrame(frameIndex));
     }
     position += velocity * deltaTime;
-    position.x = max(0.0f, min(position.x, 600.0f));
-    position.y = max(0.0f, min(position.y, 600.0f));
+    position.x = max(field.left(), min(position.x, field.right()));
+    position.y = max(field.top(), min(position.y, field.bottom()));
     playerSprite.setPosition(position);
-    for (auto& powerUp : powerUps) {
-        if (isAtFullPower) {
-            powerUp->setGravitate(true);
-            Vector2f direction = this->getPosition() - powerUp->getPosition();
-            float distance = sqrt(direction.x * direction.x + direction.y * direction.y);
-            if (distance > 0) {
-                direction /= distance;
-                powerUp->setPosition(powerUp->getPosition() + direction * 200.0f * deltaTime);
-            }
-        } else {
-            powerUp->setGravitate(false);
-        }
-        powerUp->update(deltaTime, this);
-    }
     int oldPower = powerLevel;
     if (oldPower < Player::MAX_POWER && this->getPowerLevel() >= Player::MAX_POWER) { 
         isAtFullPower = true;
         isShowingFullPower = true;
         fullPowerTimer = 0.0f;
-        fullPowerSound.play(); 
     }
 }
 
-void Player::draw(RenderWindow& window) {
+void Player::draw(RenderTarget& window) {
     if (active) {  
         window.draw(playerSprite);
     } else if (isDying) {  
@@ -193,8 +213,6 @@ void Player::hit() {
         lives--;
         currentInvincibilityTime = invincibilityTime;
         startDeathAnimation();
-        position = Vector2f(300.0f, 600.0f);  
-        playerSprite.setPosition(position);  
         powerLevel = 0;  
         isAtFullPower = false;
     }
@@ -219,25 +237,59 @@ void Player::reset(const Vector2f& position) {
     this->active = true;
     this->powerLevel = 0;
     this->shootCooldown = getShootCooldown();
-
-    if (!fullPowerSoundBuffer.loadFromFile("assets/sfx/powerup.wav")) { 
-        throw runtime_error("Failed to load powerup.wav");
-    }
-    fullPowerSound.setBuffer(fullPowerSoundBuffer); 
 }
+Player::State Player::getState() const {
+    State state = {};
+    state.entity = getEntityState();
+    state.shootCooldown = shootCooldown;
+    state.currentCooldown = currentCooldown;
+    state.currentInvincibilityTime = currentInvincibilityTime;
+    state.lives = lives;
+    state.score = score;
+    state.bombs = bombs;
+    state.powerLevel = powerLevel;
+    state.isAtFullPower = isAtFullPower;
+    state.facingLeft = facingLeft;
+    state.wasMovingUp = wasMovingUp;
+    state.isFocused = isFocused;
+    state.input = input;
+    return state;
+}
+
+void Player::setState(const State& state) {
+    setEntityState(state.entity);
+    shootCooldown = state.shootCooldown;
+    currentCooldown = state.currentCooldown;
+    currentInvincibilityTime = state.currentInvincibilityTime;
+    lives = state.lives;
+    score = state.score;
+    bombs = state.bombs;
+    powerLevel = state.powerLevel;
+    isAtFullPower = state.isAtFullPower != 0;
+    facingLeft = state.facingLeft != 0;
+    wasMovingUp = state.wasMovingUp != 0;
+    isFocused = state.isFocused != 0;
+    speed = isFocused ? focusedSpeed : normalSpeed;
+    input = state.input;
+    playerSprite.setPosition(position);
+}
+
 void Player::increasePower(int amount) {
     powerLevel = min(MAX_POWER, powerLevel + amount);
     shootCooldown = getShootCooldown();
 }
-Bullet::Bullet(const Vector2f& pos, const Vector2f& vel)
-    : Entity(pos, vel) {
-    static bool textureLoaded = false;
-    if (!textureLoaded) {
+void Bullet::loadTextures() {
+    call_once(textureOnce, [] {
         if (!bulletTexture.loadFromFile("assets/bullet.png")) {
             throw runtime_error("Failed to load bullet.png");
         }
-        textureLoaded = true;
-    }
+        MemoryTracker::trackTexture(MemoryTag::Entities, bulletTexture);
+    });
+}
+
+Bullet::Bullet(const Vector2f& pos, const Vector2f& vel, Uint8 owner)
+    : Entity(pos, vel), previousPosition(pos), owner(owner) {
+    loadTextures();
     
     bulletSprite.setTexture(bulletTexture);
     bulletSprite.setOrigin(bulletSprite.getGlobalBounds().width / 2,
@@ -246,44 +298,53 @@ Bullet::Bullet(const Vector2f& pos, const Vector2f& vel)
 }
 
 void Bullet::update(float deltaTime) {
+    previousPosition = position;
     Entity::update(deltaTime);
-    if (position.x < -10 || position.x > 810 || 
-        position.y < -10 || position.y > 610) {
-        active = false;
-    }
 }
-void Bullet::draw(RenderWindow& window) {
+void Bullet::draw(RenderTarget& window) {
     bulletSprite.setPosition(position);
     window.draw(bulletSprite);
 }
 void Bullet::hit() {
     active = false;
 }
-vector<Texture> Enemy::enemyTextures;
-bool Enemy::texturesLoaded = false;
-
-float animationTimer = 0.0f; 
-int currentFrame = 0;
-const float FRAME_TIME = 0.1f;
+SpriteSheet Enemy::enemySheet;
+vector<AnimationClip> Enemy::idleClips;
+AnimationClip Enemy::enemyDeathClip;
+once_flag Enemy::texturesOnce;
 
-Enemy::Enemy(const Vector2f& pos)
-    : Entity(pos, Vector2f(0, 300)), initialX(pos.x) {
-    animationTimer = 0.0f; 
-    currentFrame = 0;     
-    if (!texturesLoaded) {
-        enemyTextures.resize(3);
+void Enemy::loadTextures() {
+    // The death clip is cut from the shared death sheet.
+    loadDeathTextures();
+    call_once(texturesOnce, [] {
+        vector<string> paths;
         for (int i = 1; i <= 3; i++) {
-            if (!enemyTextures[i-1].loadFromFile("assets/enemies/e" + to_string(i) + ".png")) {
-                throw runtime_error("Failed to load enemy texture " + to_string(i));
-            }
+            paths.push_back("assets/enemies/e" + to_string(i) + ".png");
         }
-        texturesLoaded = true;
-    }
-    int spriteIndex = rand() % 3;
-    enemySprite.setTexture(enemyTextures[spriteIndex]);
+        if (!enemySheet.loadFromFiles(paths)) {
+            throw runtime_error("Failed to load enemy textures");
+        }
+        MemoryTracker::trackTexture(MemoryTag::Entities, enemySheet.getTexture());
+        idleClips.resize(3);
+        for (size_t i = 0; i < idleClips.size(); i++) {
+            idleClips[i].frames = {enemySheet.getFrame(i), enemySheet.getFrame(i, true)};
+            idleClips[i].frameTime = 0.1f;
+        }
+        enemyDeathClip = deathSheet.makeClip(0, 5, 0.1f, false);
+    });
+}
+
+Enemy::Enemy(const Vector2f& pos, Animator& animator, Random& random)
+    : Entity(pos, Vector2f(0, 300)), initialX(pos.x) {
+    this->animator = &animator;
+    loadTextures();
+    look = static_cast<Uint8>(random.nextInt(3));
+    idleAnim = animator.play(idleClips[look]);
+    enemySprite.setTexture(enemySheet.getTexture());
+    enemySprite.setTextureRect(enemySheet.getFrame(look));
     enemySprite.setOrigin(enemySprite.getGlobalBounds().width / 2,
                          enemySprite.getGlobalBounds().height / 2);
-    int patternIndex = rand() % 4; 
+    int patternIndex = random.nextInt(4); 
     movePattern = static_cast<Pattern>(patternIndex);
     switch (movePattern) {
         case Pattern::Straight:
@@ -299,14 +360,49 @@ Enemy::Enemy(const Vector2f& pos)
             velocity = Vector2f(0, 50); 
             break;
     }
+}
 
-    isDying = false;
-    deathAnimTimer = 0.0f;
-    currentDeathFrame = 0;
-    deathSprite.setTexture(deathTextures[0]);
-    deathSprite.setPosition(position);
-    FloatRect bounds = deathSprite.getLocalBounds();
-    deathSprite.setOrigin(bounds.width / 2.f, bounds.height / 2.f);
+Enemy::Enemy(const State& state, Animator& animator)
+    : Entity(state.entity.position, state.entity.velocity) {
+    this->animator = &animator;
+    loadTextures();
+    look = state.look;
+    idleAnim = animator.play(idleClips[look]);
+    enemySprite.setTexture(enemySheet.getTexture());
+    enemySprite.setTextureRect(enemySheet.getFrame(look));
+    enemySprite.setOrigin(enemySprite.getGlobalBounds().width / 2,
+                         enemySprite.getGlobalBounds().height / 2);
+    setState(state);
+}
+
+Enemy::~Enemy() {
+    animator->release(idleAnim);
+}
+
+Enemy::State Enemy::getState() const {
+    State state = {};
+    state.entity = getEntityState();
+    state.initialX = initialX;
+    state.totalTime = totalTime;
+    state.shootTimer = shootTimer;
+    state.look = look;
+    state.pattern = static_cast<Uint8>(movePattern);
+    state.hasShot = hasShot;
+    return state;
+}
+
+void Enemy::setState(const State& state) {
+    setEntityState(state.entity);
+    initialX = state.initialX;
+    totalTime = state.totalTime;
+    shootTimer = state.shootTimer;
+    if (state.look != look) {
+        look = state.look;
+        animator->restart(idleAnim, idleClips[look]);
+    }
+    movePattern = static_cast<Pattern>(state.pattern);
+    hasShot = state.hasShot != 0;
+    enemySprite.setPosition(position);
 }
 
 void Enemy::update(float deltaTime) {
@@ -332,24 +428,11 @@ void Enemy::update(float deltaTime) {
             break;
     }
 
-    animationTimer += deltaTime;  
-    if (animationTimer >= FRAME_TIME) {  
-        animationTimer = 0;  
-
-        if (enemySprite.getScale().x > 0) {
-            enemySprite.setScale(-1.0f, 1.0f);  
-        } else {
-            enemySprite.setScale(1.0f, 1.0f);   
-        }
-    }
     enemySprite.setPosition(position);
-
-    if (position.y > 650) {
-        active = false;
-    }
 }
 
-void Enemy::draw(RenderWindow& window) {
+void Enemy::draw(RenderTarget& window) {
+    enemySprite.setTextureRect(animator->getRect(idleAnim));
     window.draw(enemySprite);
     if (isDying) {
         drawDeathAnimation(window);
@@ -357,97 +440,405 @@ void Enemy::draw(RenderWindow& window) {
 }
 void Enemy::hit() {
     if (!isDying) {
-        startDeathAnimation(); 
+        startDeathAnimation(enemyDeathClip); 
         active = false; 
     }
 }
+namespace {
 
-void Enemy::updateDeathAnimation(float deltaTime) {
-    if (!isDying) return;
+float gunInterval(Boss::Gun gun) {
+    switch (gun) {
+        case Boss::Gun::Fan: return 2.5f;
+        case Boss::Gun::Ring: return 2.0f;
+        case Boss::Gun::Stream: return 0.8f;
+        case Boss::Gun::Homing: return 3.0f;
+        case Boss::Gun::None: break;
+    }
+    return 0.0f;
+}
 
-    deathAnimTimer += deltaTime;
+}
 
-    const float frameDuration = 0.1f;  
-    if (deathAnimTimer >= frameDuration) {
-        deathAnimTimer = 0; 
-        currentDeathFrame++; 
-        if (currentDeathFrame >= 5) { 
-            currentDeathFrame = 4;
-            isDying = false; 
-            active = false;  
-        } else {
-            deathSprite.setTexture(deathTextures[currentDeathFrame]); 
+// A core ringed by turrets, behind an arc of armour plates on the side
+// facing the player.
+Boss::Boss(const Vector2f& pos, float stopY)
+    : Entity(pos, Vector2f(0, 80)), anchorX(pos.x), stopY(stopY), vertices(Quads) {
+    Enemy::loadTextures();
+    addPart(Vector2f(0, 0), Vector2f(30, 24), 400, Gun::Ring, 1.0f, 0);
+    const size_t TURRETS = 6;
+    for (size_t i = 0; i < TURRETS; i++) {
+        float angle = 6.28318f * i / TURRETS;
+        addPart(Vector2f(cos(angle), sin(angle)) * 60.0f, Vector2f(12, 12), 40,
+                i % 2 == 0 ? Gun::Fan : Gun::Homing, 1.5f + 0.4f * i, 1);
+    }
+    const size_t PLATES = 16;
+    for (size_t i = 0; i < PLATES; i++) {
+        float angle = 3.14159f * (i + 0.5f) / PLATES;
+        addPart(Vector2f(cos(angle) * 110.0f, sin(angle) * 90.0f), Vector2f(10, 10), 20,
+                i % 4 == 1 ? Gun::Stream : Gun::None, 0.5f + 0.2f * i, 2);
+    }
+    updateBounds();
+}
+
+Boss::Boss(const State& state)
+    : Entity(state.entity.position, state.entity.velocity), vertices(Quads) {
+    Enemy::loadTextures();
+    setState(state);
+}
+
+void Boss::addPart(const Vector2f& offset, const Vector2f& halfSize, Int16 hitPoints, Gun gun, float firstShot, Uint8 look) {
+    Part& part = parts[partCount++];
+    part = {};
+    part.offset = offset;
+    part.halfSize = halfSize;
+    part.fireTimer = firstShot;
+    part.hitPoints = hitPoints;
+    part.maxHitPoints = hitPoints;
+    part.gun = static_cast<Uint8>(gun);
+    part.look = look;
+}
+
+Boss::State Boss::getState() const {
+    State state = {};
+    state.entity = getEntityState();
+    state.totalTime = totalTime;
+    state.anchorX = anchorX;
+    state.stopY = stopY;
+    state.partCount = static_cast<Uint32>(partCount);
+    copy(parts, parts + partCount, state.parts);
+    return state;
+}
+
+void Boss::setState(const State& state) {
+    setEntityState(state.entity);
+    totalTime = state.totalTime;
+    anchorX = state.anchorX;
+    stopY = state.stopY;
+    partCount = min<size_t>(state.partCount, MAX_PARTS);
+    copy(state.parts, state.parts + partCount, parts);
+    updateBounds();
+}
+
+void Boss::updateBounds() {
+    Vector2f low(0, 0);
+    Vector2f high(0, 0);
+    bool any = false;
+    for (size_t i = 0; i < partCount; i++) {
+        if (!isPartAlive(i)) continue;
+        Vector2f partLow = parts[i].offset - parts[i].halfSize;
+        Vector2f partHigh = parts[i].offset + parts[i].halfSize;
+        low = any ? Vector2f(min(low.x, partLow.x), min(low.y, partLow.y)) : partLow;
+        high = any ? Vector2f(max(high.x, partHigh.x), max(high.y, partHigh.y)) : partHigh;
+        any = true;
+    }
+    boundsOffset = (low + high) / 2.0f;
+    boundsHalfSize = (high - low) / 2.0f;
+}
+
+void Boss::update(float deltaTime) {
+    totalTime += deltaTime;
+    if (!hasArrived()) {
+        position += velocity * deltaTime;
+        // Swaying starts from the anchor, so there is no jump on arrival.
+        totalTime = 0.0f;
+    } else {
+        // Kept up to date so anything extrapolating the boss sees the sway.
+        float x = anchorX + sin(totalTime * 0.6f) * 120.0f;
+        velocity = Vector2f(deltaTime > 0.0f ? (x - position.x) / deltaTime : 0.0f, 0.0f);
+        position.x = x;
+        for (size_t i = 0; i < partCount; i++) {
+            parts[i].fireTimer -= deltaTime;
         }
     }
 }
 
-void Enemy::drawDeathAnimation(RenderWindow& window) {
-    if (isDying) { 
-        window.draw(deathSprite);
+size_t Boss::findHit(const Bullet& bullet) const {
+    HitBox sweep = bullet.getSweptBox();
+    for (size_t i = 0; i < partCount; i++) {
+        if (!isPartAlive(i)) continue;
+        HitBox box = getPartHitBox(i);
+        if (overlaps(sweep, box) && bullet.sweepHits(box)) {
+            return i;
+        }
+    }
+    return NO_PART;
+}
+
+size_t Boss::findHit(const HitCircle& circle) const {
+    for (size_t i = 0; i < partCount; i++) {
+        if (isPartAlive(i) && overlaps(circle, getPartHitBox(i))) {
+            return i;
+        }
+    }
+    return NO_PART;
+}
+
+bool Boss::damage(size_t part, int amount) {
+    Part& target = parts[part];
+    if (target.hitPoints <= 0) {
+        return false;
+    }
+    target.hitPoints = static_cast<Int16>(max(0, target.hitPoints - amount));
+    if (target.hitPoints > 0) {
+        return false;
+    }
+    updateBounds();
+    return true;
+}
+
+size_t Boss::fire(vector<unique_ptr<EnemyBullet>>& bullets, const Vector2f* targets, size_t targetCount) {
+    size_t fired = 0;
+    for (size_t i = 0; i < partCount; i++) {
+        Part& part = parts[i];
+        Gun gun = static_cast<Gun>(part.gun);
+        if (gun == Gun::None || !isPartAlive(i) || part.fireTimer > 0.0f) continue;
+        part.fireTimer += gunInterval(gun);
+
+        Vector2f origin = position + part.offset;
+        switch (gun) {
+            case Gun::Fan:
+                for (int shot = 0; shot < 5; shot++) {
+                    float radians = (-30.0f + 15.0f * shot) * 3.14159f / 180.0f;
+                    bullets.push_back(make_unique<EnemyBullet>(origin, EnemyBullet::aim(origin, targets, targetCount, radians) * 150.0f));
+                }
+                fired += 5;
+                break;
+            case Gun::Ring:
+                for (int shot = 0; shot < 16; shot++) {
+                    float radians = 6.28318f * shot / 16 + totalTime;
+                    bullets.push_back(make_unique<EnemyBullet>(origin, Vector2f(sin(radians), cos(radians)) * 120.0f));
+                }
+                fired += 16;
+                break;
+            case Gun::Stream:
+                bullets.push_back(make_unique<EnemyBullet>(origin, EnemyBullet::aim(origin, targets, targetCount) * 250.0f));
+                fired++;
+                break;
+            case Gun::Homing:
+                bullets.push_back(make_unique<EnemyBullet>(origin, Vector2f(-90, 30), EnemyBullet::HOMING_TIME));
+                bullets.push_back(make_unique<EnemyBullet>(origin, Vector2f(90, 30), EnemyBullet::HOMING_TIME));
+                fired += 2;
+                break;
+            case Gun::None:
+                break;
+        }
     }
+    return fired;
 }
-PowerUp::PowerUp(const Vector2f& pos, Type powerType)
-    : Entity(pos, Vector2f(0, 100)), type(powerType), currentFrame(0), animationTimer(0) {
-    if (!texturesLoaded) {
-        powerUpTextures.resize(5); 
+
+// One batched draw for every part; damaged parts fade towards red.
+void Boss::draw(RenderTarget& window) {
+    const SpriteSheet& sheet = Enemy::getSheet();
+    vertices.resize(partCount * 4);
+    size_t quadCount = 0;
+    for (size_t i = 0; i < partCount; i++) {
+        if (!isPartAlive(i)) continue;
+        const Part& part = parts[i];
+        IntRect frame = sheet.getFrame(part.look);
+        Vector2f center = position + part.offset;
+        // Sprites are drawn a little larger than the box they are hit by.
+        Vector2f half = part.halfSize * 1.4f;
+        Uint8 health = static_cast<Uint8>(255 * part.hitPoints / part.maxHitPoints);
+        Color tint(255, health, health);
+
+        Vertex* quad = &vertices[quadCount * 4];
+        quad[0] = Vertex(center + Vector2f(-half.x, -half.y), tint, Vector2f(frame.left, frame.top));
+        quad[1] = Vertex(center + Vector2f(half.x, -half.y), tint, Vector2f(frame.left + frame.width, frame.top));
+        quad[2] = Vertex(center + Vector2f(half.x, half.y), tint, Vector2f(frame.left + frame.width, frame.top + frame.height));
+        quad[3] = Vertex(center + Vector2f(-half.x, half.y), tint, Vector2f(frame.left, frame.top + frame.height));
+        quadCount++;
+    }
+    if (quadCount > 0) {
+        window.draw(&vertices[0], quadCount * 4, Quads, RenderStates(&sheet.getTexture()));
+    }
+}
+
+void PowerUpPool::loadTextures() {
+    call_once(texturesOnce, [] {
+        vector<string> paths;
         for (int i = 1; i <= 5; i++) {
-            if (!powerUpTextures[i-1].loadFromFile("assets/power/power" + to_string(i) + ".png")) {
-                throw runtime_error("Failed to load power" + to_string(i) + ".png");
+            paths.push_back("assets/power/power" + to_string(i) + ".png");
+        }
+        if (!powerUpSheet.loadFromFiles(paths)) {
+            throw runtime_error("Failed to load power-up textures");
+        }
+        MemoryTracker::trackTexture(MemoryTag::Entities, powerUpSheet.getTexture());
+        spinClip = powerUpSheet.makeClip(0, 5, 0.1f, true);
+    });
+}
+
+PowerUpPool::PowerUpPool(Animator& animator) : animator(animator), vertices(Quads) {
+    loadTextures();
+    spinAnim = animator.play(spinClip);
+    posX.reserve(INITIAL_CAPACITY);
+    posY.reserve(INITIAL_CAPACITY);
+    types.reserve(INITIAL_CAPACITY);
+    magnetized.reserve(INITIAL_CAPACITY);
+    vertices.resize(INITIAL_CAPACITY * 4);
+}
+
+PowerUpPool::~PowerUpPool() {
+    animator.release(spinAnim);
+}
+
+void PowerUpPool::spawn(const Vector2f& pos, Type type, bool magnetize) {
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    types.push_back(type);
+    magnetized.push_back(magnetize ? 1 : 0);
+}
+
+void PowerUpPool::removeAt(size_t index) {
+    size_t last = posX.size() - 1;
+    posX[index] = posX[last];
+    posY[index] = posY[last];
+    types[index] = types[last];
+    magnetized[index] = magnetized[last];
+    posX.pop_back();
+    posY.pop_back();
+    types.pop_back();
+    magnetized.pop_back();
+}
+
+void PowerUpPool::update(float deltaTime, Collector* collectors, size_t collectorCount, const PlayField& field) {
+    if (collectorCount == 0) return;
+
+    const float magnetRadiusSq = MAGNET_RADIUS * MAGNET_RADIUS;
+    const float pickupRadiusSq = PICKUP_RADIUS * PICKUP_RADIUS;
+    const float fallStep = FALL_SPEED * deltaTime;
+    const float magnetStep = MAGNET_SPEED * deltaTime;
+
+    size_t i = 0;
+    while (i < posX.size()) {
+        Collector* nearest = &collectors[0];
+        float dx = nearest->position.x - posX[i];
+        float dy = nearest->position.y - posY[i];
+        float distSq = dx * dx + dy * dy;
+        for (size_t c = 1; c < collectorCount; c++) {
+            float cx = collectors[c].position.x - posX[i];
+            float cy = collectors[c].position.y - posY[i];
+            float cSq = cx * cx + cy * cy;
+            if (cSq < distSq) {
+                nearest = &collectors[c];
+                dx = cx;
+                dy = cy;
+                distSq = cSq;
             }
         }
-        texturesLoaded = true;
-    }
-    powerSprite.setTexture(powerUpTextures[0]);  
-    powerSprite.setOrigin(powerSprite.getGlobalBounds().width / 2,
-                         powerSprite.getGlobalBounds().height / 2);
-    powerSprite.setPosition(pos);
-    shouldGravitate = false;
-}
-
-void PowerUp::update(float deltaTime, Player* player) {
-    if (shouldGravitate) {
-        Vector2f playerPosition = player->getPosition();
-        Vector2f direction = playerPosition - position;
-        float distance = sqrt(direction.x * direction.x + direction.y * direction.y);
-        if (distance > 0) {
-            direction /= distance; 
-            position += direction * 200.0f * deltaTime; 
+
+        if (distSq < pickupRadiusSq) {
+            if (types[i] == Type::Small) {
+                nearest->pickups.small++;
+            } else {
+                nearest->pickups.large++;
+            }
+            removeAt(i);
+            continue;
         }
-        return; 
-    }
-    position += velocity * deltaTime;
-    animationTimer += deltaTime;
-    if (animationTimer >= FRAME_TIME) {
-        animationTimer = 0;
-        currentFrame = (currentFrame + 1) % 5;  
-        powerSprite.setTexture(powerUpTextures[currentFrame]);
+
+        // Once an item starts homing it keeps homing, so the normalize below is
+        // only paid by items that are actually flying towards the player.
+        if (nearest->collectAll || distSq < magnetRadiusSq) {
+            magnetized[i] = 1;
+        }
+        if (magnetized[i]) {
+            float scale = min(1.0f, magnetStep / sqrt(distSq));
+            posX[i] += dx * scale;
+            posY[i] += dy * scale;
+        } else {
+            posY[i] += fallStep;
+            if (posY[i] > field.bottom()) {
+                removeAt(i);
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+void PowerUpPool::draw(RenderTarget& window, const PlayField& field, bool spin) {
+    if (posX.empty()) return;
+
+    const Texture& texture = powerUpSheet.getTexture();
+    IntRect frame = spin || texCoordsWritten == 0 ? animator.getRect(spinAnim) : writtenFrame;
+    if (frame != writtenFrame) {
+        writtenFrame = frame;
+        texCoordsWritten = 0;
+    }
+    Vector2f size(frame.width, frame.height);
+    Vector2f half = size / 2.0f;
+    float u = frame.left;
+    float v = frame.top;
+
+    if (vertices.getVertexCount() < posX.size() * 4) {
+        vertices.resize(posX.size() * 4);
+    }
+    size_t quadCount = 0;
+    for (size_t i = 0; i < posX.size(); i++) {
+        if (!field.isVisible(Vector2f(posX[i], posY[i]))) continue;
+
+        Vertex* quad = &vertices[quadCount * 4];
+        float left = posX[i] - half.x;
+        float top = posY[i] - half.y;
+        quad[0].position = Vector2f(left, top);
+        quad[1].position = Vector2f(left + size.x, top);
+        quad[2].position = Vector2f(left + size.x, top + size.y);
+        quad[3].position = Vector2f(left, top + size.y);
+        if (quadCount >= texCoordsWritten) {
+            quad[0].texCoords = Vector2f(u, v);
+            quad[1].texCoords = Vector2f(u + size.x, v);
+            quad[2].texCoords = Vector2f(u + size.x, v + size.y);
+            quad[3].texCoords = Vector2f(u, v + size.y);
+        }
+        quadCount++;
     }
-    powerSprite.setPosition(position);
-    if (position.y > 600) {
-        active = false;
+    texCoordsWritten = max(texCoordsWritten, quadCount);
+    if (quadCount > 0) {
+        window.draw(&vertices[0], quadCount * 4, Quads, RenderStates(&texture));
     }
 }
-void PowerUp::draw(RenderWindow& window) {
-    window.draw(powerSprite);
+
+void PowerUpPool::clear() {
+    posX.clear();
+    posY.clear();
+    types.clear();
+    magnetized.clear();
 }
-FloatRect PowerUp::getBounds() const {
-    return powerSprite.getGlobalBounds();
+
+void PowerUpPool::save(State& state) const {
+    state.posX.assign(posX.begin(), posX.end());
+    state.posY.assign(posY.begin(), posY.end());
+    state.types.assign(types.begin(), types.end());
+    state.magnetized.assign(magnetized.begin(), magnetized.end());
 }
-void PowerUp::hit() {
-    active = false;
+
+Uint32 PowerUpPool::checksum() const {
+    Uint32 hash = HASH_SEED;
+    hash = hashBytes(hash, posX.data(), posX.size() * sizeof(float));
+    hash = hashBytes(hash, posY.data(), posY.size() * sizeof(float));
+    hash = hashBytes(hash, types.data(), types.size() * sizeof(Type));
+    hash = hashBytes(hash, magnetized.data(), magnetized.size());
+    return hash;
 }
-void PowerUp::setPosition(const Vector2f& newPosition) {
-    position = newPosition;  
+
+void PowerUpPool::restore(const State& state) {
+    posX.assign(state.posX.begin(), state.posX.end());
+    posY.assign(state.posY.begin(), state.posY.end());
+    types.assign(state.types.begin(), state.types.end());
+    magnetized.assign(state.magnetized.begin(), state.magnetized.end());
 }
-EnemyBullet::EnemyBullet(const Vector2f& pos, const Vector2f& vel)
-    : Entity(pos, vel) {
-    
-    if (!textureLoaded) {
+void EnemyBullet::loadTextures() {
+    call_once(textureOnce, [] {
         if (!bulletTexture.loadFromFile("assets/bullet.png")) {
             throw runtime_error("Failed to load bullet texture");
         }
-        textureLoaded = true;
-    }
+        MemoryTracker::trackTexture(MemoryTag::Entities, bulletTexture);
+    });
+}
+
+EnemyBullet::EnemyBullet(const Vector2f& pos, const Vector2f& vel, float homingTime)
+    : Entity(pos, vel), homingTime(homingTime) {
+    loadTextures();
 
     bulletSprite.setTexture(bulletTexture);
     
@@ -460,26 +851,89 @@ EnemyBullet::EnemyBullet(const Vector2f& pos, const Vector2f& vel)
 void EnemyBullet::update(float deltaTime) {
     position += velocity * deltaTime;
     bulletSprite.setPosition(position);
-    
-    if (position.y > 650 || position.y < -50 || 
-        position.x < -50 || position.x > 650) {
-        active = false;
+}
+
+Vector2f EnemyBullet::aim(const Vector2f& from, const Vector2f* targets, size_t targetCount, float offset) {
+    Vector2f direction(0, 1);
+    float nearestSq = 0.0f;
+    for (size_t t = 0; t < targetCount; t++) {
+        Vector2f delta = targets[t] - from;
+        float distSq = delta.x * delta.x + delta.y * delta.y;
+        if (distSq > 0.0f && (nearestSq == 0.0f || distSq < nearestSq)) {
+            direction = delta;
+            nearestSq = distSq;
+        }
+    }
+    if (nearestSq > 0.0f) {
+        direction /= sqrt(nearestSq);
+    }
+    float c = cos(offset);
+    float s = sin(offset);
+    return Vector2f(direction.x * c - direction.y * s, direction.x * s + direction.y * c);
+}
+
+void EnemyBullet::updateAll(vector<unique_ptr<EnemyBullet>>& bullets, const Vector2f* targets,
+                            size_t targetCount, const PlayField& field, float deltaTime) {
+    const float turn = HOMING_TURN_RATE * deltaTime;
+    const float turnCos = cos(turn);
+    const float turnSin = sin(turn);
+
+    for (auto& pointer : bullets) {
+        EnemyBullet& bullet = *pointer;
+        if (bullet.homingTime > 0.0f && targetCount > 0) {
+            bullet.homingTime -= deltaTime;
+            Vector2f toTarget = targets[0] - bullet.position;
+            float distSq = toTarget.x * toTarget.x + toTarget.y * toTarget.y;
+            for (size_t t = 1; t < targetCount; t++) {
+                Vector2f delta = targets[t] - bullet.position;
+                float deltaSq = delta.x * delta.x + delta.y * delta.y;
+                if (deltaSq < distSq) {
+                    toTarget = delta;
+                    distSq = deltaSq;
+                }
+            }
+
+            // Comparing the dot product against the cosine of the turn scaled
+            // by both lengths avoids normalizing either vector.
+            Vector2f& velocity = bullet.velocity;
+            float speedSq = velocity.x * velocity.x + velocity.y * velocity.y;
+            float dot = velocity.x * toTarget.x + velocity.y * toTarget.y;
+            if (dot >= turnCos * sqrt(speedSq * distSq)) {
+                if (distSq > 0.0f) {
+                    velocity = toTarget * sqrt(speedSq / distSq);
+                }
+            } else {
+                float cross = velocity.x * toTarget.y - velocity.y * toTarget.x;
+                float s = cross < 0.0f ? -turnSin : turnSin;
+                velocity = Vector2f(velocity.x * turnCos - velocity.y * s,
+                                    velocity.x * s + velocity.y * turnCos);
+            }
+        }
+        bullet.position += bullet.velocity * deltaTime;
+        bullet.bulletSprite.setPosition(bullet.position);
+        if (field.isOutOfPlay(bullet.position)) {
+            bullet.active = false;
+        }
     }
 }
-void EnemyBullet::draw(RenderWindow& window) {
+void EnemyBullet::draw(RenderTarget& window) {
     window.draw(bulletSprite);
 }
 void EnemyBullet::hit() {
     active = false;
 }
-Car::Car(float yPosition) 
-    : Entity(Vector2f(800, yPosition), Vector2f(-400, 0)) {  
-    if (!textureLoaded) {
+void Car::loadTextures() {
+    call_once(textureOnce, [] {
         if (!carTexture.loadFromFile("assets/enemies/car.png")) {
             throw runtime_error("Failed to load car.png");
         }
-        textureLoaded = true;
-    }
+        MemoryTracker::trackTexture(MemoryTag::Entities, carTexture);
+    });
+}
+
+Car::Car(const Vector2f& pos) 
+    : Entity(pos, Vector2f(-400, 0)) {  
+    loadTextures();
     
     carSprite.setTexture(carTexture);
     carSprite.setOrigin(carSprite.getGlobalBounds().width / 2,
@@ -490,11 +944,8 @@ Car::Car(float yPosition)
 void Car::update(float deltaTime) {
     position += velocity * deltaTime;
     carSprite.setPosition(position);
-    if (position.x < -100) { 
-        active = false;
-    }
 }
-void Car::draw(RenderWindow& window) {
+void Car::draw(RenderTarget& window) {
     window.draw(carSprite);
 }
 FloatRect Car::getBounds() const {
@@ -2,14 +2,59 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <memory>
+#include <mutex>
 #include <cmath>
 #include <vector>
+#include "input.hpp"
+#include "collision.hpp"
+#include "animation.hpp"
+#include "arena.hpp"
+#include "random.hpp"
+#include "checksum.hpp"
 
 using namespace std;
 using namespace sf;
 
 class Player;
 
+// The square the game is played in. Culling, spawn placement and the game
+// view are all derived from it so they cannot drift apart.
+struct PlayField {
+    // Entities this far outside the visible area are still simulated, which
+    // leaves room to spawn them just off screen.
+    static constexpr float CULL_MARGIN = 128.0f;
+    // Covers the largest sprite half-extent (the car) so nothing pops at the edge.
+    static constexpr float DRAW_MARGIN = 64.0f;
+
+    FloatRect bounds;
+
+    explicit PlayField(float size) : bounds(0, 0, size, size) {}
+
+    float left() const { return bounds.left; }
+    float top() const { return bounds.top; }
+    float right() const { return bounds.left + bounds.width; }
+    float bottom() const { return bounds.top + bounds.height; }
+
+    bool isWithin(const Vector2f& pos, float margin) const {
+        return pos.x >= left() - margin && pos.x <= right() + margin &&
+               pos.y >= top() - margin && pos.y <= bottom() + margin;
+    }
+    bool isVisible(const Vector2f& pos) const { return isWithin(pos, DRAW_MARGIN); }
+    bool isOutOfPlay(const Vector2f& pos) const { return !isWithin(pos, CULL_MARGIN); }
+};
+
+// Plain copies of the simulated fields, used by world snapshots. The State
+// structs below are laid out without padding so a snapshot's bytes depend
+// only on the game state. Sprites and animation handles are presentation and
+// are rebuilt from these on restore.
+struct EntityState {
+    Vector2f position;
+    Vector2f velocity;
+    Uint8 active;
+    Uint8 isDying;
+    Uint8 reserved[2];
+};
+
 class Entity {
 protected:
     Vector2f position;
@@ -17,30 +62,39 @@ protected:
     unique_ptr<Shape> shape;
     bool active = true;
     bool isDying = false;
-    float deathAnimTimer = 0.0f;
-    static vector<Texture> deathTextures;
+    // Art is shared by every world and only read once loaded. Each kind loads
+    // under a once_flag, so worlds may be built on several threads at once.
+    static SpriteSheet deathSheet;
+    static AnimationClip deathClip;
+    static once_flag deathTexturesOnce;
     Sprite deathSprite;
-    static bool deathTexturesLoaded;
-    int currentDeathFrame = 0;
+    // Set by entities that animate; their handles are released on destruction.
+    Animator* animator = nullptr;
+    size_t deathAnim = Animator::NONE;
     static constexpr float DEATH_FRAME_TIME = 0.05f; 
     static constexpr float FLASH_FRAME_TIME = 0.03f; 
     virtual void hit() = 0;
+    void startDeathAnimation(const AnimationClip& clip);
+    EntityState getEntityState() const;
+    // Starts the death animation if the restored state is dying and this
+    // entity was not.
+    void setEntityState(const EntityState& state);
 
 public:
     Entity(const Vector2f& pos, const Vector2f& vel);
-    virtual ~Entity() = default;
+    virtual ~Entity();
     
     virtual void update(float deltaTime);
-    virtual void draw(RenderWindow& window);
+    virtual void draw(RenderTarget& window);
 
     bool isActive() const;
     void setActive(bool state);
     Vector2f getPosition() const;
+    Vector2f getVelocity() const { return velocity; }
     virtual FloatRect getBounds() const { return shape ? shape->getGlobalBounds() : FloatRect(); }
     virtual void startDeathAnimation();
-    bool isInDeathAnimation() const { return isDying; }
-    void updateDeathAnimation(float deltaTime);
-    virtual void drawDeathAnimation(RenderWindow& window);
+    bool isInDeathAnimation() const;
+    virtual void drawDeathAnimation(RenderTarget& window);
     static void loadDeathTextures();
 
     virtual void update(float deltaTime, Player* player) = 0;  
@@ -63,31 +117,60 @@ private:
     bool isShowingFullPower = false;
     float fullPowerTimer = 0.0f;      
 
-    vector<Texture> animFrames;
-    float animationTimer = 0.0f;
-    const float FRAME_TIME = 0.1f;
-    size_t currentFrame = 0;
+    // Frame layout of the shared sheet: up, down, then the sideways cycle.
+    static SpriteSheet sheet;
+    static once_flag sheetOnce;
+    static const size_t FRAME_UP = 0;
+    static const size_t FRAME_DOWN = 1;
+    static const size_t FRAME_SIDE = 2;
+    static const size_t SIDE_FRAME_COUNT = 4;
+    static AnimationClip sideClip;
+
+    size_t sideAnim;
+    bool facingLeft = false;
 
     Sprite playerSprite;
-    Texture upTexture;
-    Texture downTexture;
-    vector<Texture> leftAnimFrames;
-    vector<Texture> rightAnimFrames;
     bool wasMovingUp = true;  
 
-    float normalSpeed = 400.0f;
-    float focusedSpeed = 200.0f;
+    float normalSpeed = NORMAL_SPEED;
+    float focusedSpeed = FOCUSED_SPEED;
     bool isFocused = false;
 
-    SoundBuffer fullPowerSoundBuffer; 
-    Sound fullPowerSound;
+    InputState input;
+    // The ship is kept inside this.
+    PlayField field;
 
 public:
+    struct State {
+        EntityState entity;
+        float shootCooldown;
+        float currentCooldown;
+        float currentInvincibilityTime;
+        Int32 lives;
+        Int32 score;
+        Int32 bombs;
+        Int32 powerLevel;
+        Uint8 isAtFullPower;
+        Uint8 facingLeft;
+        Uint8 wasMovingUp;
+        Uint8 isFocused;
+        InputState input;
+        Uint8 reserved[3];
+    };
+
     static const int MAX_POWER;  
+    static constexpr float NORMAL_SPEED = 400.0f;
+    static constexpr float FOCUSED_SPEED = 200.0f;
+    // Much smaller than the sprite, and unaffected by the sideways stretch.
+    static constexpr float HIT_RADIUS = 5.0f;
+    // Enemy bullets that come this close without hitting score a graze.
+    static constexpr float GRAZE_RADIUS = 24.0f;
 
-    explicit Player(const Vector2f& pos);
+    Player(const Vector2f& pos, const PlayField& field, Animator& animator);
+    ~Player() override;
+    static void loadTextures();
     void update(float deltaTime) override;
-    void draw(RenderWindow& window) override; 
+    void draw(RenderTarget& window) override; 
     bool canShoot();
     bool isInvincible() const { return currentInvincibilityTime > 0; }
     void hit() override;  
@@ -107,15 +190,20 @@ public:
     }
     float getShootCooldown() const { return max(0.05f, 0.1f - (powerLevel * 0.005f)); }  
     FloatRect getBounds() const override { return playerSprite.getGlobalBounds(); }
+    HitCircle getHitCircle() const { return {position, HIT_RADIUS}; }
+    HitCircle getGrazeCircle() const { return {position, GRAZE_RADIUS}; }
     void setPosition(const Vector2f& pos) {
         position = pos;
         playerSprite.setPosition(position);
     }
+    // Tells the ships apart in co-op; the sheet is shared, so this is per sprite.
+    void setTint(const Color& color) { playerSprite.setColor(color); }
 
-    vector<Vector2f> getFocusedBulletPositions() const {
-        vector<Vector2f> positions;
+    ArenaVector<Vector2f> getFocusedBulletPositions(FrameArena& arena) const {
+        ArenaVector<Vector2f> positions{ArenaAllocator<Vector2f>(arena)};
         int rows = 1 + (powerLevel / 2); 
         float verticalSpacing = 10.0f; 
+        positions.reserve(rows);
         
         for (int i = 0; i < rows; i++) {
             float xOffset = 0;
@@ -125,6 +213,9 @@ public:
         return positions;
     }
     bool getIsFocused() const { return isFocused; }
+    void setInput(const InputState& state) { input = state; }
+    State getState() const;
+    void setState(const State& state);
     void addLife() {
         lives++;
     }
@@ -133,39 +224,118 @@ public:
     }
 };
 
-class Bullet : public Entity {
+class Bullet : public Entity, public FreeListAllocated<Bullet> {
 private:
     Sprite bulletSprite;
     static Texture bulletTexture;  
+    static once_flag textureOnce;
+    Vector2f previousPosition;
+    Uint8 owner;
 public:
-    Bullet(const Vector2f& pos, const Vector2f& vel);
-    void draw(RenderWindow& window) override;
+    struct State {
+        EntityState entity;
+        Vector2f previousPosition;
+        Uint8 owner;
+        Uint8 reserved[3];
+    };
+
+    static constexpr float HIT_HALF_WIDTH = 4.0f;
+    static constexpr float HIT_HALF_HEIGHT = 7.0f;
+
+    // owner is the index of the player that fired it, who scores its kills.
+    Bullet(const Vector2f& pos, const Vector2f& vel, Uint8 owner = 0);
+    static void loadTextures();
+    State getState() const { return {getEntityState(), previousPosition, owner, {0, 0, 0}}; }
+    void setState(const State& state) {
+        setEntityState(state.entity);
+        previousPosition = state.previousPosition;
+        owner = state.owner;
+    }
+    Uint8 getOwner() const { return owner; }
+    void draw(RenderTarget& window) override;
     void update(float deltaTime) override;
     FloatRect getBounds() const override { return bulletSprite.getGlobalBounds(); }
+    // Tests the whole path travelled during the last update, so fast bullets
+    // cannot tunnel through small targets when the frame time spikes.
+    bool sweepHits(const HitBox& target) const {
+        return sweptOverlaps(previousPosition, position, Vector2f(HIT_HALF_WIDTH, HIT_HALF_HEIGHT), target);
+    }
+    // Box around everything sweepHits can touch, for cheap rejection first.
+    HitBox getSweptBox() const {
+        Vector2f center = (previousPosition + position) / 2.0f;
+        Vector2f reach(fabs(position.x - previousPosition.x) / 2.0f + HIT_HALF_WIDTH,
+                       fabs(position.y - previousPosition.y) / 2.0f + HIT_HALF_HEIGHT);
+        return {center, reach};
+    }
     void hit() override;
     void update(float deltaTime, Player* player) override {
         // Implement the update logic for Bullet
     }
 };
 
-class EnemyBullet : public Entity {
+class EnemyBullet final : public Entity, public FreeListAllocated<EnemyBullet> {
 private:
     Sprite bulletSprite;
     static Texture bulletTexture;
-    static bool textureLoaded;
+    static once_flag textureOnce;
+
+    // Seconds of steering left; the bullet flies straight once it runs out.
+    float homingTime = 0.0f;
+    // One bit per player this bullet has already been grazed by.
+    Uint8 grazedBy = 0;
 
 public:
-    EnemyBullet(const Vector2f& pos, const Vector2f& vel);
+    struct State {
+        EntityState entity;
+        float homingTime;
+        Uint8 grazedBy;
+        Uint8 reserved[3];
+    };
+
+    static constexpr float HIT_RADIUS = 3.0f;
+    // Radians a second a homing bullet can turn through.
+    static constexpr float HOMING_TURN_RATE = 1.5f;
+    static constexpr float HOMING_TIME = 2.5f;
+
+    EnemyBullet(const Vector2f& pos, const Vector2f& vel, float homingTime = 0.0f);
+    static void loadTextures();
+    // Unit vector from `from` towards the nearest target, or straight down
+    // when there is none, turned by `offset` radians for spreads.
+    static Vector2f aim(const Vector2f& from, const Vector2f* targets, size_t targetCount, float offset = 0.0f);
+    // Steers and moves every bullet in one pass over the list, and retires
+    // those that leave the field. A homing bullet's velocity is rotated
+    // towards its nearest target by at most this step's turn, so its speed
+    // never changes; the sine and cosine of that turn are worked out once
+    // for the whole pass.
+    static void updateAll(vector<unique_ptr<EnemyBullet>>& bullets, const Vector2f* targets,
+                          size_t targetCount, const PlayField& field, float deltaTime);
+    State getState() const {
+        State state = {};
+        state.entity = getEntityState();
+        state.homingTime = homingTime;
+        state.grazedBy = grazedBy;
+        return state;
+    }
+    void setState(const State& state) {
+        setEntityState(state.entity);
+        homingTime = state.homingTime;
+        grazedBy = state.grazedBy;
+        bulletSprite.setPosition(position);
+    }
+    bool isHoming() const { return homingTime > 0.0f; }
     void update(float deltaTime) override;
-    void draw(RenderWindow& window) override;
+    void draw(RenderTarget& window) override;
     FloatRect getBounds() const override { return bulletSprite.getGlobalBounds(); }
+    HitCircle getHitCircle() const { return {position, HIT_RADIUS}; }
+    bool isGrazedBy(size_t player) const { return (grazedBy >> player) & 1; }
+    void setGrazedBy(size_t player) { grazedBy |= static_cast<Uint8>(1 << player); }
     void hit() override;
     void update(float deltaTime, Player* player) override {
         // Implement the update logic for EnemyBullet
     }
 };
 
-class Enemy : public Entity {
+class Enemy : public Entity, public FreeListAllocated<Enemy> {
 public:
     enum class Pattern {
         Straight,
@@ -174,25 +344,51 @@ public:
         Shooter    
     };
 
-    explicit Enemy(const Vector2f& pos);
+    struct State {
+        EntityState entity;
+        float initialX;
+        float totalTime;
+        float shootTimer;
+        Uint8 look;
+        Uint8 pattern;
+        Uint8 hasShot;
+        Uint8 reserved;
+    };
+
+    static constexpr float HIT_HALF_WIDTH = 13.0f;
+    static constexpr float HIT_HALF_HEIGHT = 36.0f;
+
+    Enemy(const Vector2f& pos, Animator& animator, Random& random);
+    // Rebuilds an enemy from a snapshot without rolling its look or pattern.
+    Enemy(const State& state, Animator& animator);
+    ~Enemy() override;
+    static void loadTextures();
+    static const SpriteSheet& getSheet() { return enemySheet; }
+    State getState() const;
+    void setState(const State& state);
+    using Entity::startDeathAnimation;
+    void startDeathAnimation() override { startDeathAnimation(enemyDeathClip); }
     void update(float deltaTime) override;
-    void draw(RenderWindow& window) override;
+    void draw(RenderTarget& window) override;
     FloatRect getBounds() const override { return enemySprite.getGlobalBounds(); }
+    HitBox getHitBox() const { return {position, Vector2f(HIT_HALF_WIDTH, HIT_HALF_HEIGHT)}; }
     bool canShoot() const { return movePattern == Pattern::Shooter && shootTimer <= 0; }
     Vector2f getPosition() const { return position; }
     bool hasShot = false;  
     static const int BURST_SIZE = 5; 
     void hit();  
-
-    void updateDeathAnimation(float deltaTime); 
-    void drawDeathAnimation(RenderWindow& window); 
     void update(float deltaTime, Player* player) override {
         // Implement the update logic for Enemy
     }
 private:
-    static vector<Texture> enemyTextures;
-    static bool texturesLoaded;
+    static SpriteSheet enemySheet;
+    // One clip per enemy look; each alternates the frame with its mirror.
+    static vector<AnimationClip> idleClips;
+    static AnimationClip enemyDeathClip;
+    static once_flag texturesOnce;
     Sprite enemySprite;
+    size_t idleAnim;
+    Uint8 look = 0;
     Pattern movePattern;
     float waveAmplitude = 100.0f;
     float waveFrequency = 2.0f;
@@ -203,53 +399,188 @@ private:
     const float shootChance = 0.3f;  
 };
 
-class PowerUp : public Entity {
+// A large enemy built from parts, each with its own hitbox, hit points and
+// gun. Destroying the core, part 0, beats the boss; the other parts can be
+// shot off first for points. Hits are tested against the box around every
+// live part before any single part, so a boss costs about one enemy for
+// bullets that are nowhere near it.
+class Boss : public Entity, public FreeListAllocated<Boss> {
+public:
+    enum class Gun : Uint8 {
+        None,
+        // Five shots fanned around the nearest player, like a shooter
+        // enemy's burst.
+        Fan,
+        // Shots in every direction.
+        Ring,
+        // One fast shot at the nearest player.
+        Stream,
+        // A pair of slow shots thrown out sideways that curve in on the
+        // nearest player.
+        Homing
+    };
+
+    // Offsets are from the boss's position.
+    struct Part {
+        Vector2f offset;
+        Vector2f halfSize;
+        float fireTimer;
+        Int16 hitPoints;
+        Int16 maxHitPoints;
+        Uint8 gun;
+        Uint8 look;
+        Uint8 reserved[2];
+    };
+
+    static constexpr size_t MAX_PARTS = 32;
+    static constexpr size_t CORE = 0;
+    static constexpr size_t NO_PART = static_cast<size_t>(-1);
+    static constexpr int BOMB_DAMAGE = 40;
+
+    struct State {
+        EntityState entity;
+        float totalTime;
+        float anchorX;
+        float stopY;
+        Uint32 partCount;
+        Part parts[MAX_PARTS];
+    };
+
+    // Flies down from pos and holds at stopY, swaying from side to side.
+    Boss(const Vector2f& pos, float stopY);
+    explicit Boss(const State& state);
+    State getState() const;
+    void setState(const State& state);
+
+    void update(float deltaTime) override;
+    void draw(RenderTarget& window) override;
+    void hit() override { active = false; }
+    void update(float deltaTime, Player* player) override {}
+
+    size_t getPartCount() const { return partCount; }
+    bool isPartAlive(size_t part) const { return parts[part].hitPoints > 0; }
+    Vector2f getPartPosition(size_t part) const { return position + parts[part].offset; }
+    HitBox getPartHitBox(size_t part) const { return {position + parts[part].offset, parts[part].halfSize}; }
+    // Box around every live part.
+    HitBox getHitBox() const { return {position + boundsOffset, boundsHalfSize}; }
+    // The first live part hit, or NO_PART. Callers test getHitBox() first.
+    size_t findHit(const Bullet& bullet) const;
+    size_t findHit(const HitCircle& circle) const;
+    // Returns true when this destroys the part.
+    bool damage(size_t part, int amount);
+    // Fires every gun that is due; returns the number of bullets added.
+    size_t fire(vector<unique_ptr<EnemyBullet>>& bullets, const Vector2f* targets, size_t targetCount);
+
+private:
+    Part parts[MAX_PARTS];
+    size_t partCount = 0;
+    float totalTime = 0.0f;
+    float anchorX;
+    float stopY;
+    Vector2f boundsOffset;
+    Vector2f boundsHalfSize;
+    VertexArray vertices;
+
+    // firstShot staggers the guns so they do not all fire on one tick.
+    void addPart(const Vector2f& offset, const Vector2f& halfSize, Int16 hitPoints, Gun gun, float firstShot, Uint8 look);
+    void updateBounds();
+    bool hasArrived() const { return position.y >= stopY; }
+};
+
+class PowerUpPool {
 public:
-    enum class Type {
+    enum class Type : Uint8 {
         Small,
         Large
     };
 
+    struct Pickups {
+        int small = 0;
+        int large = 0;
+    };
+
+    // A player the items can home in on, and what that player picked up.
+    struct Collector {
+        Vector2f position;
+        bool collectAll = false;
+        Pickups pickups;
+    };
+
+    struct State {
+        vector<float> posX;
+        vector<float> posY;
+        vector<Type> types;
+        vector<Uint8> magnetized;
+    };
+
+    static constexpr size_t INITIAL_CAPACITY = 4096;
+    static constexpr float FALL_SPEED = 100.0f;
+    static constexpr float MAGNET_SPEED = 500.0f;
+    static constexpr float MAGNET_RADIUS = 48.0f;
+    static constexpr float PICKUP_RADIUS = 24.0f;
+    static constexpr float AUTO_COLLECT_LINE = 150.0f;
+
+    explicit PowerUpPool(Animator& animator);
+    ~PowerUpPool();
+    static void loadTextures();
+    void spawn(const Vector2f& pos, Type type, bool magnetized = false);
+    // Moves, magnetizes and collects every item in one pass over the arrays.
+    // Each item deals only with its nearest collector; with that collector's
+    // collectAll set it homes in regardless of distance.
+    void update(float deltaTime, Collector* collectors, size_t collectorCount, const PlayField& field);
+    // With spin off the items hold their current frame.
+    void draw(RenderTarget& window, const PlayField& field, bool spin = true);
+    void clear();
+    size_t size() const { return posX.size(); }
+    // Copies reuse the destination's capacity, so steady-state saves do not allocate.
+    void save(State& state) const;
+    void restore(const State& state);
+    Uint32 checksum() const;
+
 private:
-    static vector<Texture> powerUpTextures;
-    static bool texturesLoaded;
-    Sprite powerSprite;
-    Type type; 
-    int currentFrame;
-    float animationTimer;
-    static constexpr float FRAME_TIME = 0.1f;
-    bool shouldGravitate = false;
+    static SpriteSheet powerUpSheet;
+    static AnimationClip spinClip;
+    static once_flag texturesOnce;
 
-public:
-    PowerUp(const Vector2f& pos, Type powerType);
-    void update(float deltaTime, Player* player) override;
-    void draw(RenderWindow& window) override;
-    FloatRect getBounds() const override;
-    Type getType() const { return type; }
-    void hit() override;
-    void setPosition(const Vector2f& newPosition);
-    void setGravitate(bool gravitate) {
-        shouldGravitate = gravitate;
-    }
+    vector<float> posX;
+    vector<float> posY;
+    vector<Type> types;
+    vector<Uint8> magnetized;
+    // Every item shows the same frame, so the pool runs a single animation.
+    Animator& animator;
+    size_t spinAnim;
+    VertexArray vertices;
+    // Every item shows the same frame, so texture coordinates only need
+    // writing for quads that have not had this frame's yet.
+    IntRect writtenFrame;
+    size_t texCoordsWritten = 0;
 
-    void handleFullPower(Player* player) {
-        if (player->getPowerLevel() >= Player::MAX_POWER) {
-            type = Type::Large; 
-        }
-    }
+    void removeAt(size_t index);
 };
 
-class Car : public Entity {
+class Car : public Entity, public FreeListAllocated<Car> {
 private:
     static Texture carTexture;
-    static bool textureLoaded;
+    static once_flag textureOnce;
     Sprite carSprite;
 
 public:
-    Car(float yPosition);
+    using State = EntityState;
+
+    static constexpr float HIT_HALF_WIDTH = 54.0f;
+    static constexpr float HIT_HALF_HEIGHT = 18.0f;
+
+    explicit Car(const Vector2f& pos);
+    static void loadTextures();
+    State getState() const { return getEntityState(); }
+    void setState(const State& state) {
+        setEntityState(state);
+        carSprite.setPosition(position);
+    }
     void update(float deltaTime) override;
-    void draw(RenderWindow& window) override;
+    void draw(RenderTarget& window) override;
     FloatRect getBounds() const override;
+    HitBox getHitBox() const { return {position, Vector2f(HIT_HALF_WIDTH, HIT_HALF_HEIGHT)}; }
     void hit() override;
     void update(float deltaTime, Player* player) override {
         // Implement the update logic for Car
@@ -0,0 +1,77 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+
+using namespace std;
+using namespace sf;
+
+// Something the simulation wants the rest of the game to react to. Kept
+// small so a tick's worth of them fits in a few cache lines.
+struct GameEvent {
+    enum class Type : Uint8 {
+        Kill,
+        PlayerHit,
+        Pickup,
+        Extend,
+        FullPower,
+        BossDefeated,
+        Graze
+    };
+
+    // What hit the player, for PlayerHit events.
+    enum class Source : Uint8 {
+        None,
+        Enemy,
+        EnemyBullet,
+        Car,
+        Boss
+    };
+
+    Type type;
+    Source source = Source::None;
+    // Power gained by a Pickup.
+    Uint8 amount = 0;
+    // The player that scored, was hit or picked something up.
+    Uint8 player = 0;
+    Vector2f position;
+};
+
+// Fixed-size ring buffer. Collision passes push into it while they iterate;
+// the consumers drain it afterwards, so no container is modified mid-loop.
+class EventQueue {
+public:
+    static constexpr size_t CAPACITY = 1024;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    // Drops the event and counts it when the queue is full.
+    bool push(const GameEvent& event) {
+        if (tail - head == CAPACITY) {
+            dropped++;
+            return false;
+        }
+        events[tail & (CAPACITY - 1)] = event;
+        tail++;
+        return true;
+    }
+
+    bool pop(GameEvent& event) {
+        if (head == tail) {
+            return false;
+        }
+        event = events[head & (CAPACITY - 1)];
+        head++;
+        return true;
+    }
+
+    bool empty() const { return head == tail; }
+    size_t size() const { return tail - head; }
+    size_t getDropped() const { return dropped; }
+    void clear() { head = tail; }
+
+private:
+    array<GameEvent, CAPACITY> events;
+    size_t head = 0;
+    size_t tail = 0;
+    size_t dropped = 0;
+};
@@ -0,0 +1,79 @@
+#include "input.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace sf;
+
+InputState InputState::fromKeyboard() {
+    InputState state;
+    state.set(Left, Keyboard::isKeyPressed(Keyboard::Left));
+    state.set(Right, Keyboard::isKeyPressed(Keyboard::Right));
+    state.set(Up, Keyboard::isKeyPressed(Keyboard::Up));
+    state.set(Down, Keyboard::isKeyPressed(Keyboard::Down));
+    state.set(Focus, Keyboard::isKeyPressed(Keyboard::LShift) ||
+                     Keyboard::isKeyPressed(Keyboard::RShift));
+    state.set(Shoot, Keyboard::isKeyPressed(Keyboard::Z));
+    state.set(Bomb, Keyboard::isKeyPressed(Keyboard::X));
+    return state;
+}
+
+bool InputScript::loadFromFile(const string& path) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Error opening input script: " << path << endl;
+        return false;
+    }
+
+    steps.clear();
+    totalFrames = 0;
+    currentStep = 0;
+    frameInStep = 0;
+
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        istringstream fields(line);
+        Step step;
+        string keys;
+        if (!(fields >> step.frames >> keys)) {
+            cerr << path << ":" << lineNumber << ": expected '<frames> <buttons>'" << endl;
+            return false;
+        }
+        for (char key : keys) {
+            switch (key) {
+                case 'L': step.state.set(InputState::Left, true); break;
+                case 'R': step.state.set(InputState::Right, true); break;
+                case 'U': step.state.set(InputState::Up, true); break;
+                case 'D': step.state.set(InputState::Down, true); break;
+                case 'F': step.state.set(InputState::Focus, true); break;
+                case 'Z': step.state.set(InputState::Shoot, true); break;
+                case 'X': step.state.set(InputState::Bomb, true); break;
+                case '-': break;
+                default:
+                    cerr << path << ":" << lineNumber << ": unknown button '" << key << "'" << endl;
+                    return false;
+            }
+        }
+        steps.push_back(step);
+        totalFrames += step.frames;
+    }
+    return true;
+}
+
+bool InputScript::next(InputState& state) {
+    while (currentStep < steps.size() && frameInStep >= steps[currentStep].frames) {
+        currentStep++;
+        frameInStep = 0;
+    }
+    if (currentStep >= steps.size()) {
+        return false;
+    }
+    state = steps[currentStep].state;
+    frameInStep++;
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <SFML/Window.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace sf;
+
+// The buttons the simulation reads each frame, packed so that scripts and
+// other non-keyboard sources can drive the game exactly like a player.
+struct InputState {
+    enum Button : Uint8 {
+        Left = 1 << 0,
+        Right = 1 << 1,
+        Up = 1 << 2,
+        Down = 1 << 3,
+        Focus = 1 << 4,
+        Shoot = 1 << 5,
+        Bomb = 1 << 6
+    };
+
+    Uint8 buttons = 0;
+
+    bool has(Button button) const { return (buttons & button) != 0; }
+    void set(Button button, bool pressed) {
+        buttons = pressed ? (buttons | button) : (buttons & ~button);
+    }
+
+    static InputState fromKeyboard();
+};
+
+// Plays back a text script of held buttons. Each line is "<frames> <buttons>",
+// where buttons is any of L R U D F (focus) Z (shoot) X (bomb), or "-" for none.
+// Blank lines and lines starting with '#' are ignored.
+class InputScript {
+public:
+    bool loadFromFile(const string& path);
+    // Returns false once the script has run out of frames.
+    bool next(InputState& state);
+    size_t getTotalFrames() const { return totalFrames; }
+
+private:
+    struct Step {
+        size_t frames;
+        InputState state;
+    };
+
+    vector<Step> steps;
+    size_t totalFrames = 0;
+    size_t currentStep = 0;
+    size_t frameInStep = 0;
+};
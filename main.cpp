@@ -5,9 +5,26 @@
 #include <SFML/Audio.hpp>
 #include <iostream>
 #include "entities.hpp"
+#include "pacing.hpp"
+#include "input.hpp"
+#include "startup.hpp"
+#include "memory.hpp"
+#include "audio.hpp"
+#include "music.hpp"
+#include "world.hpp"
+#include "replay.hpp"
+#include "netplay.hpp"
+#include "bot.hpp"
+#include "batch.hpp"
+#include "quality.hpp"
 #include <fstream>
 #include <algorithm>
 #include <random>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <future>
+#include <cstring>
 
 using namespace std;
 using namespace sf;
@@ -18,6 +35,186 @@ enum class GameState {
     GameOver
 };
 
+struct LaunchOptions {
+    FramePacer::Mode pacing = FramePacer::Mode::Sleep;
+    // Offscreen runs draw into a RenderTexture instead of a window, step the
+    // game with a fixed delta and print draw timings when they finish.
+    bool offscreen = false;
+    string scriptPath;
+    size_t maxFrames = 0;
+    size_t dumpEvery = 0;
+    string dumpDir = "frames";
+    float tickRate = 60.0f;
+    bool startupReport = false;
+    size_t musicBufferFrames = MusicPlayer::DEFAULT_BUFFER_FRAMES;
+    string recordPath;
+    string replayPath;
+    // Replay playback starts at this tick, reached by restoring the nearest
+    // keyframe and simulating forward without drawing.
+    Uint32 seekTick = 0;
+    // Seeks straight to the last tick, so only the final frame is drawn.
+    bool fastForward = false;
+    // Netplay co-op with the peer at netHost:netPeerPort, controlling ship
+    // netPlayer (0 or 1) from UDP port netPort.
+    string netHost;
+    unsigned short netPeerPort = 0;
+    unsigned short netPort = 7970;
+    size_t netPlayer = 0;
+    NetConditions netConditions;
+    // The autopilot flies the local ship, restarting after each game over.
+    bool autoplay = false;
+    // Prints frame times, memory and pool use every this many frames, so a
+    // long unattended run shows leaks and drift as they develop.
+    size_t soakReportEvery = 0;
+    // Runs the games listed in this file headlessly on batchThreads threads
+    // (0 for every core), prints their results and exits.
+    string batchPath;
+    size_t batchThreads = 0;
+    // Pins the quality governor to this level; -1 lets it follow frame times.
+    int qualityLevel = -1;
+};
+
+bool parseLaunchOptions(int argc, char* argv[], LaunchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        // Numbers go through stoi and friends, which throw on text that is
+        // not a number at all.
+        try {
+            if (arg.rfind("--pacing=", 0) == 0) {
+                if (!FramePacer::parseMode(arg.substr(9), options.pacing)) {
+                    cerr << "Unknown pacing mode: " << arg.substr(9) << " (expected vsync, sleep or uncapped)" << endl;
+                    return false;
+                }
+            } else if (arg.rfind("--tick-rate=", 0) == 0) {
+                options.tickRate = stof(arg.substr(12));
+                if (options.tickRate <= 0.0f) {
+                    cerr << "--tick-rate must be positive" << endl;
+                    return false;
+                }
+            } else if (arg.rfind("--music-buffer=", 0) == 0) {
+                options.musicBufferFrames = stoul(arg.substr(15));
+                if (options.musicBufferFrames == 0) {
+                    cerr << "--music-buffer must be positive" << endl;
+                    return false;
+                }
+            } else if (arg == "--startup-report") {
+                options.startupReport = true;
+            } else if (arg == "--offscreen") {
+                options.offscreen = true;
+            } else if (arg.rfind("--script=", 0) == 0) {
+                options.scriptPath = arg.substr(9);
+            } else if (arg.rfind("--frames=", 0) == 0) {
+                options.maxFrames = stoul(arg.substr(9));
+            } else if (arg.rfind("--dump-every=", 0) == 0) {
+                options.dumpEvery = stoul(arg.substr(13));
+            } else if (arg.rfind("--dump-dir=", 0) == 0) {
+                options.dumpDir = arg.substr(11);
+            } else if (arg.rfind("--record=", 0) == 0) {
+                options.recordPath = arg.substr(9);
+            } else if (arg.rfind("--replay=", 0) == 0) {
+                options.replayPath = arg.substr(9);
+            } else if (arg.rfind("--seek=", 0) == 0) {
+                options.seekTick = stoul(arg.substr(7));
+            } else if (arg == "--fast-forward") {
+                options.fastForward = true;
+            } else if (arg.rfind("--netplay=", 0) == 0) {
+                string peer = arg.substr(10);
+                size_t colon = peer.rfind(':');
+                if (colon == string::npos || colon == 0 || stoul(peer.substr(colon + 1)) == 0) {
+                    cerr << "--netplay expects <host>:<port>" << endl;
+                    return false;
+                }
+                options.netHost = peer.substr(0, colon);
+                options.netPeerPort = static_cast<unsigned short>(stoul(peer.substr(colon + 1)));
+            } else if (arg.rfind("--net-port=", 0) == 0) {
+                options.netPort = static_cast<unsigned short>(stoul(arg.substr(11)));
+            } else if (arg.rfind("--net-player=", 0) == 0) {
+                options.netPlayer = stoul(arg.substr(13));
+                if (options.netPlayer < 1 || options.netPlayer > MAX_PLAYERS) {
+                    cerr << "--net-player must be 1 or 2" << endl;
+                    return false;
+                }
+                options.netPlayer--;
+            } else if (arg.rfind("--net-latency=", 0) == 0) {
+                options.netConditions.latencyMs = stoi(arg.substr(14));
+            } else if (arg.rfind("--net-loss=", 0) == 0) {
+                options.netConditions.lossPercent = stof(arg.substr(11));
+            } else if (arg == "--autoplay") {
+                options.autoplay = true;
+            } else if (arg.rfind("--soak-report=", 0) == 0) {
+                options.soakReportEvery = stoul(arg.substr(14));
+            } else if (arg.rfind("--batch=", 0) == 0) {
+                options.batchPath = arg.substr(8);
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                options.batchThreads = stoul(arg.substr(10));
+            } else if (arg.rfind("--quality=", 0) == 0) {
+                string level = arg.substr(10);
+                bool isNumber = !level.empty() && level.find_first_not_of("0123456789") == string::npos;
+                options.qualityLevel = level == "auto" ? -1 : isNumber ? stoi(level) : -2;
+                if (options.qualityLevel < -1 || options.qualityLevel > QualityGovernor::MAX_LEVEL) {
+                    cerr << "--quality expects auto or 0-" << QualityGovernor::MAX_LEVEL << endl;
+                    return false;
+                }
+            } else {
+                cerr << "Unknown option: " << arg << endl;
+                return false;
+            }
+        } catch (const logic_error&) {
+            size_t equals = arg.find('=');
+            cerr << "Bad value for " << arg.substr(0, equals) << ": " << arg.substr(equals + 1)
+                 << " (expected a number)" << endl;
+            return false;
+        }
+    }
+    if (options.batchThreads > 0 && options.batchPath.empty()) {
+        cerr << "--threads needs --batch" << endl;
+        return false;
+    }
+    if (options.offscreen && options.scriptPath.empty() && options.replayPath.empty() && options.maxFrames == 0) {
+        cerr << "--offscreen needs --script, --replay or --frames to know when to stop" << endl;
+        return false;
+    }
+    if (!options.replayPath.empty() && !options.scriptPath.empty()) {
+        cerr << "--replay and --script cannot be combined" << endl;
+        return false;
+    }
+    if (options.autoplay && (!options.replayPath.empty() || !options.scriptPath.empty())) {
+        cerr << "--autoplay cannot be combined with --replay or --script" << endl;
+        return false;
+    }
+    if ((options.seekTick > 0 || options.fastForward) && options.replayPath.empty()) {
+        cerr << "--seek and --fast-forward need --replay" << endl;
+        return false;
+    }
+    // Predicted ticks get rewound, so a netplay game has no single input
+    // history to record until every tick is confirmed.
+    if (!options.netHost.empty() && (!options.replayPath.empty() || !options.recordPath.empty())) {
+        cerr << "--netplay cannot be combined with --replay or --record" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Rewrites a HUD counter's String in place before handing it to its Text.
+// Building a fresh sf::String allocates every time; this one keeps its
+// capacity, and Text copies it into the buffer it already has, so neither
+// touches the heap once the counter has shown its longest value.
+void setCounterText(Text& text, String& storage, const char* value) {
+    size_t length = strlen(value);
+    if (storage.getSize() > length) {
+        storage.erase(length, storage.getSize() - length);
+    }
+    for (size_t i = 0; i < length; i++) {
+        Uint32 character = static_cast<unsigned char>(value[i]);
+        if (i < storage.getSize()) {
+            storage[i] = character;
+        } else {
+            storage.insert(i, String(character));
+        }
+    }
+    text.setString(storage);
+}
+
 int loadHighScore() {
     ifstream file("highscore.txt");
     int highScore = 0;
@@ -34,10 +231,14 @@ void saveHighScore(int score) {
     }
 }
 
+string randomBackgroundPath() {
+    int randomIndex = rand() % 6 + 1;
+    return "assets/bg/bg" + to_string(randomIndex) + ".png"; 
+}
+
 Texture loadRandomBackground() {
     Texture texture;
-    int randomIndex = rand() % 6 + 1;
-    string filename = "assets/bg/bg" + to_string(randomIndex) + ".png"; 
+    string filename = randomBackgroundPath();
     if (!texture.loadFromFile(filename)) {
         cerr << "Error loading background image: " << filename << endl;
     }
@@ -67,27 +268,69 @@ Text createGradientText(const string& textString, const Font& font, int characte
     return text; 
 }
 
-void showSlideshow(RenderWindow& window, Font& font) {
+string slidePath(int index) {
+    return "assets/title/story" + to_string(index + 1) + ".png";
+}
+
+future<Image> decodeSlideAsync(int index) {
+    return async(launch::async, [index] {
+        Image image;
+        image.loadFromFile(slidePath(index));
+        return image;
+    });
+}
+
+// Waits for a slide decoded by decodeSlideAsync and uploads it into texture.
+bool uploadSlide(future<Image>& pending, Texture& texture, int index) {
+    Image image = pending.get();
+    if (image.getSize().x == 0 || !texture.loadFromImage(image)) {
+        cerr << "Error loading slide image: " << slidePath(index) << endl;
+        return false;
+    }
+    MemoryTracker::trackTexture(MemoryTag::UI, texture);
+    return true;
+}
+
+void fitSlide(Sprite& sprite, const Texture& texture, const RenderWindow& window) {
+    sprite.setTexture(texture, true);
+    sprite.setPosition(0, 0);
+
+    // Scale to fill the window while maintaining aspect ratio
+    float scaleX = static_cast<float>(window.getSize().x) / texture.getSize().x;
+    float scaleY = static_cast<float>(window.getSize().y) / texture.getSize().y;
+    float scale = max(scaleX, scaleY); // Use the larger scale to fill the screen
+    sprite.setScale(scale, scale);
+}
+
+void showSlideshow(RenderWindow& window, FramePacer& pacer, StartupReport& startup, Font& font) {
     const int NUM_SLIDES = 6;
-    Texture slideTextures[NUM_SLIDES];
-    Sprite slideSprites[NUM_SLIDES];
-    
-    // Load slideshow images
-    for (int i = 0; i < NUM_SLIDES; ++i) {
-        if (!slideTextures[i].loadFromFile("assets/title/story" + to_string(i + 1) + ".png")) {
-            cerr << "Error loading slide image: assets/title/story" << (i + 1) << ".png" << endl;
-            return;
+    // Only the slide on screen and the one after it are ever resident. The
+    // next slide is decoded on a worker thread and uploaded as soon as it is
+    // ready, so advancing never waits on the disk.
+    Texture slideTextures[2];
+    struct SlideTracking {
+        Texture* textures;
+        ~SlideTracking() {
+            MemoryTracker::untrackTexture(textures[0]);
+            MemoryTracker::untrackTexture(textures[1]);
         }
-        slideSprites[i].setTexture(slideTextures[i]);
-        slideSprites[i].setPosition(0, 0);
-        
-        // Scale to fill the window while maintaining aspect ratio
-        float scaleX = static_cast<float>(window.getSize().x) / slideTextures[i].getSize().x;
-        float scaleY = static_cast<float>(window.getSize().y) / slideTextures[i].getSize().y;
-        float scale = max(scaleX, scaleY); // Use the larger scale to fill the screen
-        slideSprites[i].setScale(scale, scale);
+    } slideTracking{slideTextures};
+    int currentTexture = 0;
+    Sprite slideSprite;
+    future<Image> pendingSlide;
+    bool nextUploaded = false;
+
+    pendingSlide = decodeSlideAsync(0);
+    if (!uploadSlide(pendingSlide, slideTextures[currentTexture], 0)) {
+        return;
+    }
+    fitSlide(slideSprite, slideTextures[currentTexture], window);
+    if (NUM_SLIDES > 1) {
+        pendingSlide = decodeSlideAsync(1);
     }
 
+    RectangleShape fadeOverlay(Vector2f(window.getSize().x, window.getSize().y));
+
     float fadeAlpha = 0.0f;
     const float FADE_SPEED = 255.0f / 2.0f; // Adjust fade speed
     int currentSlide = 0;
@@ -110,6 +353,15 @@ void showSlideshow(RenderWindow& window, Font& font) {
             }
         }
 
+        int nextSlide = currentSlide + 1;
+        if (!nextUploaded && nextSlide < NUM_SLIDES &&
+            pendingSlide.wait_for(chrono::seconds(0)) == future_status::ready) {
+            if (!uploadSlide(pendingSlide, slideTextures[1 - currentTexture], nextSlide)) {
+                return;
+            }
+            nextUploaded = true;
+        }
+
         // Update fade effect and slide duration
         elapsedTime += clock.restart().asSeconds(); // Get the elapsed time
         if (elapsedTime >= slideDuration) {
@@ -121,6 +373,17 @@ void showSlideshow(RenderWindow& window, Font& font) {
             if (fadeAlpha >= 255.0f) {
                 fadeAlpha = 255.0f;
                 currentSlide++;
+                if (currentSlide < NUM_SLIDES) {
+                    if (!nextUploaded && !uploadSlide(pendingSlide, slideTextures[1 - currentTexture], currentSlide)) {
+                        return;
+                    }
+                    currentTexture = 1 - currentTexture;
+                    fitSlide(slideSprite, slideTextures[currentTexture], window);
+                    nextUploaded = false;
+                    if (currentSlide + 1 < NUM_SLIDES) {
+                        pendingSlide = decodeSlideAsync(currentSlide + 1);
+                    }
+                }
                 isFadingOut = false; // Reset fading
                 fadeAlpha = 0.0f; // Reset fade for next slide
                 elapsedTime = 0.0f; // Reset elapsed time for the next slide
@@ -130,19 +393,37 @@ void showSlideshow(RenderWindow& window, Font& font) {
         // Draw current slide
         window.clear(Color::Black);
         if (currentSlide < NUM_SLIDES) {
-            window.draw(slideSprites[currentSlide]);
+            window.draw(slideSprite);
         }
 
         // Draw fade overlay
-        RectangleShape fadeOverlay(Vector2f(window.getSize().x, window.getSize().y));
         fadeOverlay.setFillColor(Color(0, 0, 0, fadeAlpha));
         window.draw(fadeOverlay);
 
-        window.display();
+        pacer.display(window);
+        startup.markFirstFrame();
+    }
+}
+
+// Decodes an image queued on the prefetcher and uploads it on this thread.
+bool loadPrefetchedTexture(Texture& texture, AssetPrefetcher& prefetcher, const string& path) {
+    const Image* image = prefetcher.waitForImage(path);
+    if (!image) {
+        return false;
+    }
+    if (!texture.loadFromImage(*image)) {
+        return false;
     }
+    MemoryTracker::trackTexture(MemoryTag::UI, texture);
+    return true;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    LaunchOptions options;
+    if (!parseLaunchOptions(argc, argv, options)) {
+        return -1;
+    }
+
     const float WINDOW_WIDTH = 800.0f;
     const float WINDOW_HEIGHT = 600.0f;
     const float GAME_SIZE = 600.0f;
@@ -150,90 +431,166 @@ int main() {
     const float GAME_X = 0;  
     const float GAME_Y = 0;
 
-    RenderWindow window(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Hong Kong 97");
-    window.setFramerateLimit(60);
+    // Batches never open a window; the art is loaded here so the workers
+    // only ever read it.
+    if (!options.batchPath.empty()) {
+        BatchRunner batch(PlayField(GAME_SIZE), 1.0f / options.tickRate);
+        if (!batch.loadFromFile(options.batchPath)) {
+            return -1;
+        }
+        MemoryTracker::setThreadTag(MemoryTag::Entities);
+        World::loadAssets();
+        batch.run(options.batchThreads);
+        batch.print(cout);
+        return batch.allPassed() ? 0 : 1;
+    }
 
-    FloatRect gameArea(GAME_X, GAME_Y, GAME_SIZE, GAME_SIZE);
-    
-    Music music;
-    if (!music.openFromFile("assets/song.mp3")) {
-        cerr << "Error loading music file! Make sure 'song.mp3' exists in the current directory." << endl;
+    MemoryTracker::setThreadTag(MemoryTag::Assets);
+    StartupReport startup;
+    startup.beginPhase("window");
+    RenderWindow window;
+    RenderTexture canvas;
+    if (options.offscreen) {
+        if (!canvas.create(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+            cerr << "Error creating offscreen render target!" << endl;
+            return -1;
+        }
+        MemoryTracker::trackTexture(MemoryTag::UI, canvas.getTexture());
     } else {
-        music.setLoop(true);
-        music.setVolume(100.0f); 
-        music.play();
-        cout << "Music started playing..." << endl;
+        window.create(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Hong Kong 97");
     }
-
-    SoundBuffer shootSoundBuffer;
-    if (!shootSoundBuffer.loadFromFile("assets/sfx/plst00.wav")) {
-        cerr << "Error loading shoot sound file!" << endl;
+    RenderTarget& target = options.offscreen ? static_cast<RenderTarget&>(canvas) : window;
+    FramePacer pacer(options.pacing, 60.0f);
+    if (window.isOpen()) {
+        pacer.apply(window);
     }
-    Sound shootSound;
-    shootSound.setBuffer(shootSoundBuffer);
 
-    SoundBuffer deathSoundBuffer;
-    if (!deathSoundBuffer.loadFromFile("assets/sfx/pldead00.wav")) {
-        cerr << "Error loading death sound file!" << endl;
+    InputScript script;
+    const bool scripted = !options.scriptPath.empty();
+    if (scripted && !script.loadFromFile(options.scriptPath)) {
+        return -1;
     }
-    Sound deathSound;
-    deathSound.setBuffer(deathSoundBuffer);
-
-    SoundBuffer powerUpSoundBuffer;
-    if (!powerUpSoundBuffer.loadFromFile("assets/sfx/item00.wav")) {
-        cerr << "Error loading power-up sound file!" << endl;
+    Replay replay;
+    const bool replaying = !options.replayPath.empty();
+    if (replaying && !replay.loadFromFile(options.replayPath)) {
+        return -1;
+    }
+    // Live games can be recorded; replays already are.
+    const bool recording = !options.recordPath.empty() && !replaying;
+    NetSession net;
+    const bool netplay = !options.netHost.empty();
+    if (netplay && !net.open(options.netPort, IpAddress(options.netHost), options.netPeerPort,
+                             options.netPlayer, options.netConditions)) {
+        return -1;
+    }
+    // Scripted and offscreen runs skip the title flow and use a fixed step so
+    // that the same script always produces the same frames. Replays carry
+    // their own step lengths. Netplay needs the fixed step so both sides
+    // simulate the same ticks.
+    const bool autoStart = scripted || replaying || options.offscreen || netplay || options.autoplay;
+    const float FIXED_DELTA = 1.0f / options.tickRate;
+    if (options.offscreen && options.dumpEvery > 0) {
+        filesystem::create_directories(options.dumpDir);
     }
-    Sound powerUpSound;
-    powerUpSound.setBuffer(powerUpSoundBuffer);
 
-    SoundBuffer enemyDeathSoundBuffer;
-    if (!enemyDeathSoundBuffer.loadFromFile("assets/sfx/enep00.wav")) {
-        cerr << "Error loading enemy death sound file!" << endl;
+    startup.beginPhase("first screen");
+    Image icon;
+    if (!startup.load(icon, "icon.png")) { 
+        cerr << "Error loading icon image!" << endl;
+        return -1; 
+    }
+    if (window.isOpen()) {
+        window.setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
     }
-    Sound enemyDeathSound;
-    enemyDeathSound.setBuffer(enemyDeathSoundBuffer);
 
-    SoundBuffer enemyShootSoundBuffer;
-    if (!enemyShootSoundBuffer.loadFromFile("assets/sfx/tan02.wav")) {
-        cerr << "Error loading enemy shoot sound file!" << endl;
+    Font font;
+    if (!startup.load(font, "assets/DFPPOPCorn-W12.ttf")) { 
+        cerr << "Error loading font!" << endl;
+        return -1;
     }
-    Sound enemyShootSound;
-    enemyShootSound.setBuffer(enemyShootSoundBuffer);
 
-    SoundBuffer fullPowerSoundBuffer;
-    if (!fullPowerSoundBuffer.loadFromFile("assets/sfx/powerup.wav")) {
-        cerr << "Error loading full power sound file!" << endl;
+    // Everything past the first screen is decoded in the background while the
+    // slideshow plays, and only uploaded once the game actually needs it.
+    const string backgroundPath = randomBackgroundPath();
+    AssetPrefetcher prefetcher(startup);
+    prefetcher.addSound("assets/sfx/plst00.wav");
+    prefetcher.addSound("assets/sfx/pldead00.wav");
+    prefetcher.addSound("assets/sfx/item00.wav");
+    prefetcher.addSound("assets/sfx/enep00.wav");
+    prefetcher.addSound("assets/sfx/tan02.wav");
+    prefetcher.addSound("assets/sfx/powerup.wav");
+    prefetcher.addSound("assets/sfx/extend.wav");
+    prefetcher.addImage("assets/title/title.png");
+    prefetcher.addImage("assets/bg/ba.gif");
+    prefetcher.addImage("assets/logo.png");
+    prefetcher.addImage("assets/gameover.png");
+    prefetcher.addImage(backgroundPath);
+    prefetcher.start();
+
+    PlayField field(GAME_SIZE);
+    View gameView(field.bounds);
+    gameView.setViewport(FloatRect(
+        0,
+        0,
+        field.bounds.width / WINDOW_WIDTH,
+        field.bounds.height / WINDOW_HEIGHT
+    ));
+    
+    startup.beginPhase("music");
+    MemoryTracker::setThreadTag(MemoryTag::Audio);
+    MusicPlayer music(options.musicBufferFrames);
+    music.loadPlaylist("assets/music/playlist.txt");
+    music.play("title");
+
+    MemoryTracker::setThreadTag(MemoryTag::UI);
+    if (!autoStart) {
+        startup.beginPhase("slideshow");
+        showSlideshow(window, pacer, startup, font);
     }
-    Sound fullPowerSound;
-    fullPowerSound.setBuffer(fullPowerSoundBuffer);
 
-    SoundBuffer extendSoundBuffer;
-    if (!extendSoundBuffer.loadFromFile("assets/sfx/extend.wav")) {
-        cerr << "Error loading extend sound file!" << endl;
+    startup.beginPhase("game assets");
+    MemoryTracker::setThreadTag(MemoryTag::Audio);
+    // The buffers stay owned by the prefetcher; the audio thread just plays them.
+    struct SoundFile {
+        SoundId id;
+        const char* path;
+        const char* name;
+    };
+    const SoundFile soundFiles[] = {
+        {SoundId::Shoot, "assets/sfx/plst00.wav", "shoot"},
+        {SoundId::PlayerDeath, "assets/sfx/pldead00.wav", "death"},
+        {SoundId::PowerUp, "assets/sfx/item00.wav", "power-up"},
+        {SoundId::EnemyDeath, "assets/sfx/enep00.wav", "enemy death"},
+        {SoundId::EnemyShoot, "assets/sfx/tan02.wav", "enemy shoot"},
+        {SoundId::FullPower, "assets/sfx/powerup.wav", "full power"},
+        {SoundId::Extend, "assets/sfx/extend.wav", "extend"},
+    };
+    AudioThread audio;
+    for (const SoundFile& file : soundFiles) {
+        SoundBuffer* buffer = prefetcher.waitForSound(file.path);
+        if (buffer) {
+            audio.setBuffer(file.id, *buffer);
+        } else {
+            cerr << "Error loading " << file.name << " sound file!" << endl;
+        }
     }
-    Sound extendSound;
-    extendSound.setBuffer(extendSoundBuffer);
+    audio.start();
 
-    Player player(Vector2f(GAME_X + GAME_SIZE/2, 550));
+    startup.beginPhase("entities");
+    MemoryTracker::setThreadTag(MemoryTag::Entities);
+    Entity::loadDeathTextures();
 
-    vector<unique_ptr<Bullet>> bullets;
-    vector<unique_ptr<Enemy>> enemies;
-    vector<unique_ptr<PowerUp>> powerUps;
-    vector<unique_ptr<EnemyBullet>> enemyBullets;
-    vector<unique_ptr<Car>> cars;
+    Animator animator;
+    FrameArena frameArena;
+    World world(field, animator, netplay ? MAX_PLAYERS : 1);
+    // F5 stores the world here and F9 jumps back to it.
+    WorldSnapshot checkpoint;
+    bool hasCheckpoint = false;
     
     Clock clock;
-    float enemySpawnTimer = 0;
-    float enemySpawnInterval = 0.5f;
-    float carSpawnTimer = 0;
-    float carSpawnInterval = 2.0f;  
-
-    Font font;
-    if (!font.loadFromFile("assets/DFPPOPCorn-W12.ttf")) { 
-        cerr << "Error loading font!" << endl;
-        return -1;
-    }
 
+    startup.beginPhase("hud");
+    MemoryTracker::setThreadTag(MemoryTag::UI);
     Text scoreText = createGradientText("Score: 0", font, 20, Color::Red, Color::Yellow);
     Text livesText = createGradientText("Lives: 3", font, 20, Color::Green, Color::Blue);
     Text powerText = createGradientText("Power: 1", font, 20, Color::White, Color::Black);
@@ -257,7 +614,7 @@ int main() {
     menuText.setFillColor(Color::White);
 
     Texture hudTexture;
-    if (!hudTexture.loadFromFile("assets/bg/ba.gif")) {
+    if (!loadPrefetchedTexture(hudTexture, prefetcher, "assets/bg/ba.gif")) {
         cerr << "Error loading HUD background texture!" << endl;
         return -1;
     }
@@ -282,6 +639,26 @@ int main() {
     bombText.setOutlineColor(Color::Black); 
     bombText.setOutlineThickness(2); 
 
+    // The other ship's score and lives, in co-op.
+    Text partnerText;
+    partnerText.setFont(font);
+    partnerText.setCharacterSize(16);
+    partnerText.setFillColor(hudTextColor);
+    partnerText.setOutlineColor(Color::Black);
+    partnerText.setOutlineThickness(2);
+
+    String scoreString;
+    String livesString;
+    String powerString;
+    String bombString;
+    String partnerString;
+    int shownScore = -1;
+    int shownLives = -1;
+    int shownPower = -1;
+    int shownBombs = -1;
+    int shownPartnerScore = -1;
+    int shownPartnerLives = -1;
+
     const float HUD_X = GAME_SIZE + 20;  
     const float TEXT_PADDING = 40;
 
@@ -291,6 +668,15 @@ int main() {
     powerText.setPosition(HUD_X, 10 + TEXT_PADDING * 4);
     bombText.setPosition(HUD_X, 10 + TEXT_PADDING * 5); 
 
+    Text frameStatsText;
+    frameStatsText.setFont(font);
+    frameStatsText.setCharacterSize(14);
+    frameStatsText.setFillColor(Color::White);
+    frameStatsText.setOutlineColor(Color::Black);
+    frameStatsText.setOutlineThickness(1);
+    frameStatsText.setPosition(HUD_X, 250);
+    bool showFrameStats = false;
+
     Text fullPowerText;
     fullPowerText.setFont(font);
     fullPowerText.setString("FULL POWER!");
@@ -301,9 +687,10 @@ int main() {
     float fullPowerTimer = 0.0f;
     const float FULL_POWER_DURATION = 1.0f;  
 
-    Entity::loadDeathTextures();
-
-    Texture backgroundTexture = loadRandomBackground();
+    Texture backgroundTexture;
+    if (!loadPrefetchedTexture(backgroundTexture, prefetcher, backgroundPath)) {
+        cerr << "Error loading background image: " << backgroundPath << endl;
+    }
     Sprite backgroundSprite(backgroundTexture);
     backgroundSprite.setScale(
         (WINDOW_WIDTH / backgroundTexture.getSize().x) * 0.75f, 
@@ -323,10 +710,11 @@ int main() {
 
     Texture gameOverTexture;
     Sprite gameOverSprite;
+    RectangleShape fadeOverlay(Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
     bool isGameOver = false;
     float fadeAlpha = 0.0f; 
     const float FADE_SPEED = 255.0f / 2.0f; 
-    if (!gameOverTexture.loadFromFile("assets/gameover.png")) {
+    if (!loadPrefetchedTexture(gameOverTexture, prefetcher, "assets/gameover.png")) {
         cerr << "Error loading game over texture!" << endl;
         return -1;
     }
@@ -334,7 +722,7 @@ int main() {
     gameOverSprite.setPosition(0, 0); 
 
     Texture logoTexture;
-    if (!logoTexture.loadFromFile("assets/logo.png")) {
+    if (!loadPrefetchedTexture(logoTexture, prefetcher, "assets/logo.png")) {
         cerr << "Error loading logo texture!" << endl;
         return -1; 
     }
@@ -342,16 +730,9 @@ int main() {
     logoSprite.setPosition(HUD_X, 500);
     logoSprite.setScale(0.5f, 0.5f);
 
-    Image icon;
-    if (!icon.loadFromFile("icon.png")) { 
-        cerr << "Error loading icon image!" << endl;
-        return -1; 
-    }
-    
-    window.setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
     // title screen
     Texture titleTexture;
-    if (!titleTexture.loadFromFile("assets/title/title.png")) {
+    if (!loadPrefetchedTexture(titleTexture, prefetcher, "assets/title/title.png")) {
         cerr << "Error loading title image!" << endl;
         return -1; 
     }
@@ -362,12 +743,8 @@ int main() {
     );
     titleSprite.setPosition(0, 0);
 
-    // put borders in game
-    Texture borderTexture;
-    if (!borderTexture.loadFromFile("assets/bg/ba.gif")) {
-        cerr << "Error loading border texture!" << endl;
-        return -1; 
-    }
+    // put borders in game; same image as the HUD, so share its texture
+    const Texture& borderTexture = hudTexture;
     RectangleShape topBorder(Vector2f(GAME_SIZE, 20)); //top
     topBorder.setPosition(GAME_X, GAME_Y); 
 
@@ -380,30 +757,119 @@ int main() {
     leftBorder.setPosition(GAME_X, GAME_Y); 
 
     // Show the slideshow before the title screen
-    showSlideshow(window, font);
+    startup.finish();
+    if (options.startupReport) {
+        startup.print(cout);
+    }
+
+    InputState input;
+    // Set while netplay is stalled, so a script's input waits for its tick.
+    bool holdInput = false;
+    const size_t localPlayer = netplay ? net.getLocalPlayer() : 0;
+    Autopilot pilot;
+    size_t gamesStarted = 0;
+    size_t frameNumber = 0;
+    Clock benchmarkClock;
+    double totalSimMs = 0.0;
+    double totalDrawMs = 0.0;
+    double maxDrawMs = 0.0;
+    size_t benchmarkStartAllocations = MemoryTracker::totalAllocations();
+    size_t statsStartFrame = 0;
+    size_t statsStartAllocations = benchmarkStartAllocations;
+    double soakSimMs = 0.0;
+    double soakDrawMs = 0.0;
+    double soakMaxFrameMs = 0.0;
+    size_t soakStartAllocations = benchmarkStartAllocations;
+
+    // Offscreen runs are benchmarks and frame dumps, which must not change
+    // with how fast the machine happens to be.
+    QualityGovernor governor(1000.0f / 60.0f);
+    if (options.qualityLevel >= 0) {
+        governor.pin(options.qualityLevel);
+    } else if (options.offscreen) {
+        governor.pin(0);
+    }
+    Text* hudTexts[] = {&highScoreText, &scoreText, &livesText, &powerText, &bombText, &partnerText};
+    auto applyHudQuality = [&] {
+        float outline = governor.isEnabled(QualityGovernor::Feature::HudOutlines) ? 2.0f : 0.0f;
+        for (Text* text : hudTexts) {
+            text->setOutlineThickness(outline);
+        }
+    };
+    applyHudQuality();
+    // With repeats shed, a sound that just started is not restarted for
+    // this many frames.
+    const size_t SOUND_REPEAT_FRAMES = 4;
+    array<size_t, SOUND_COUNT> soundStartedFrame = {};
+    auto playSound = [&](SoundId sound) {
+        size_t& started = soundStartedFrame[static_cast<size_t>(sound)];
+        if (!governor.isEnabled(QualityGovernor::Feature::SoundRepeats) &&
+            frameNumber - started < SOUND_REPEAT_FRAMES) {
+            return;
+        }
+        started = frameNumber;
+        audio.play(sound);
+    };
 
-    while (window.isOpen()) {
-        float deltaTime = clock.restart().asSeconds();
-        enemySpawnTimer += deltaTime;
-        carSpawnTimer += deltaTime;
+    while (options.offscreen || window.isOpen()) {
+        if (options.maxFrames > 0 && frameNumber >= options.maxFrames) {
+            break;
+        }
+        float deltaTime = autoStart ? FIXED_DELTA : clock.restart().asSeconds();
+        benchmarkClock.restart();
+        bool startRequested = autoStart && gameState == GameState::Menu;
+        bool saveCheckpoint = false;
+        bool restoreCheckpoint = false;
         Event event;
-        while (window.pollEvent(event)) {
+        while (window.isOpen() && window.pollEvent(event)) {
             if (event.type == Event::Closed)
                 window.close();
             
             if (event.type == Event::KeyPressed) {
                 if (event.key.code == Keyboard::Enter && gameState == GameState::Menu) {
-                    gameState = GameState::Playing;
-                    player.reset(Vector2f(GAME_X + GAME_SIZE/2, 550));
-                    bullets.clear();
-                    enemies.clear();
-                    enemySpawnTimer = 0;
+                    startRequested = true;
                 }
-                if (event.key.code == Keyboard::X && gameState == GameState::Playing) {
-                    if (player.useBomb()) {
-                        enemies.clear();
-                    }
+                if (event.key.code == Keyboard::F3) {
+                    showFrameStats = !showFrameStats;
                 }
+                if (event.key.code == Keyboard::F5 && gameState == GameState::Playing && !replaying && !netplay) {
+                    saveCheckpoint = true;
+                }
+                if (event.key.code == Keyboard::F9 && gameState == GameState::Playing && !replaying && !netplay && hasCheckpoint) {
+                    restoreCheckpoint = true;
+                }
+            }
+        }
+
+        if (scripted) {
+            if (!holdInput && !script.next(input)) {
+                break;
+            }
+        } else if (!options.offscreen) {
+            // Keyboard state is global; with both netplay windows on one
+            // machine only the focused one should steer.
+            input = (!netplay || window.hasFocus()) ? InputState::fromKeyboard() : InputState();
+        }
+
+        if (startRequested) {
+            gamesStarted++;
+            gameState = GameState::Playing;
+            music.play("stage1");
+            world.reset();
+            hasCheckpoint = false;
+            if (recording) {
+                replay.clear();
+            }
+            if (replaying) {
+                Uint32 lastTick = replay.getTickCount() > 0 ? replay.getTickCount() - 1 : 0;
+                Uint32 seekTick = options.fastForward ? lastTick : min(options.seekTick, lastTick);
+                Clock seekClock;
+                if (!replay.seek(world, seekTick, frameArena)) {
+                    cerr << "Replay has no keyframe at or before tick " << seekTick << endl;
+                    return -1;
+                }
+                cout << "replay: reached tick " << seekTick << " of " << replay.getTickCount()
+                     << " in " << seekClock.getElapsedTime().asMilliseconds() << " ms" << endl;
             }
         }
 
@@ -411,270 +877,137 @@ int main() {
             window.clear(Color::Black);
             window.draw(titleSprite); 
             window.draw(menuText); 
-            window.display();
+            pacer.display(window);
             continue;
         }
 
-        if (enemySpawnTimer >= enemySpawnInterval) {
-            enemySpawnTimer = 0;
-            float randomX = rand() % 700 + 50;
-            enemies.push_back(make_unique<Enemy>(Vector2f(randomX, -50)));
+        MemoryTracker::setThreadTag(MemoryTag::Entities);
+        // Once a replay runs out, a window keeps showing its last frame;
+        // offscreen playback just stops.
+        bool replayFinished = replaying && world.getTick() >= replay.getTickCount();
+        if (replayFinished && options.offscreen) {
+            break;
         }
-
-        if (carSpawnTimer >= carSpawnInterval) {
-            carSpawnTimer = 0;
-            float randomY = rand() % 500 + 50;  
-            cars.push_back(make_unique<Car>(randomY));
+        if (options.autoplay) {
+            input = pilot.think(world, localPlayer);
         }
-
-        if (Keyboard::isKeyPressed(Keyboard::Z) && player.canShoot()) {
-            shootSound.play();
-            
-            if (player.getIsFocused()) {
-                auto bulletPositions = player.getFocusedBulletPositions();
-                for (const auto& pos : bulletPositions) {
-                    bullets.push_back(make_unique<Bullet>(
-                        pos,
-                        Vector2f(0, -800)  
-                    ));
-                }
+        PlayerInputs inputs = {};
+        inputs[localPlayer] = input;
+        if (replaying && !replayFinished) {
+            replay.verify(world);
+            const Replay::Frame& frame = replay.getFrame(world.getTick());
+            inputs = frame.inputs;
+            deltaTime = frame.deltaTime;
+        }
+        if (saveCheckpoint || restoreCheckpoint) {
+            Clock snapshotClock;
+            if (saveCheckpoint) {
+                world.save(checkpoint);
+                hasCheckpoint = true;
             } else {
-                int spreadCount = player.getSpreadCount();
-                float spreadAngle = 15.0f;
-                
-                for (int i = 0; i < spreadCount; i++) {
-                    float angle = -spreadAngle * (spreadCount - 1) / 2.0f + spreadAngle * i;
-                    float radians = angle * 3.14159f / 180.0f;
-                    
-                    Vector2f bulletVelocity(
-                        -sin(radians) * 800,
-                        -cos(radians) * 800
-                    );
-                    
-                    bullets.push_back(make_unique<Bullet>(
-                        player.getPosition(),
-                        bulletVelocity
-                    ));
+                world.restore(checkpoint);
+                isGameOver = false;
+                if (recording) {
+                    replay.truncate(world.getTick());
                 }
             }
+            cout << (saveCheckpoint ? "checkpoint saved" : "checkpoint restored")
+                 << " in " << snapshotClock.getElapsedTime().asMicroseconds() << " us" << endl;
         }
-
-        player.update(deltaTime);
-
-        for (auto& bullet : bullets) {
-            bullet->update(deltaTime);
+        if (recording) {
+            if (world.getTick() % Replay::KEYFRAME_INTERVAL == 0) {
+                replay.addKeyframe(world);
+            }
+            replay.addFrame(inputs, deltaTime, world.checksum());
         }
-
-        for (auto& enemy : enemies) {
-            enemy->update(deltaTime);
+        const WorldEffects noEffects;
+        const WorldEffects* stepped = nullptr;
+        if (netplay) {
+            net.receive(world, deltaTime, frameArena);
+            stepped = net.advance(world, input, deltaTime, frameArena);
+            holdInput = !stepped;
+            net.send();
+        } else if (!replayFinished) {
+            stepped = &world.step(inputs, deltaTime, frameArena);
         }
-
-        for (auto& powerUp : powerUps) {
-            if (powerUp->isActive()) {
-                powerUp->update(deltaTime, &player); 
-            }
+        const WorldEffects& effects = stepped ? *stepped : noEffects;
+        animator.update(deltaTime);
+
+        if (effects.shot) playSound(SoundId::Shoot);
+        if (effects.enemyShot) playSound(SoundId::EnemyShoot);
+        if (effects.enemyDeath) playSound(SoundId::EnemyDeath);
+        if (effects.playerDeath) playSound(SoundId::PlayerDeath);
+        if (effects.powerUp) playSound(SoundId::PowerUp);
+        if (effects.extend) {
+            playSound(SoundId::Extend);
+            isShowingLifeUp = true; 
+            lifeUpTimer = 0.0f; 
         }
-
-        for (auto& car : cars) {
-            car->update(deltaTime);
+        if (effects.fullPower) {
+            playSound(SoundId::FullPower);
+            isShowingFullPower = true;
+            fullPowerTimer = 0.0f;
         }
-
-        bullets.erase(
-            remove_if(bullets.begin(), bullets.end(),
-                [](const auto& bullet) { return !bullet->isActive(); }),
-            bullets.end()
-        );
-
-        enemies.erase(
-            remove_if(enemies.begin(), enemies.end(),
-                [](const auto& enemy) { return !enemy->isActive(); }),
-            enemies.end()
-        );
-
-        for (auto& enemy : enemies) {
-            if (!player.isInvincible() && player.getBounds().intersects(enemy->getBounds())) {
-                deathSound.play();
-                player.hit();
-                if (player.getLives() <= 0) {
-                    if (!isGameOver) {
-                        isGameOver = true; 
-                    }
-                }
-            }
-            
-            for (auto& bullet : bullets) {
-                if (bullet->isActive() && enemy->isActive() && 
-                    bullet->getBounds().intersects(enemy->getBounds())) {
-                    enemyDeathSound.play();
-                    bullet->setActive(false);
-                    enemy->hit();  
-                    player.addScore(100);
-                    
-                    Vector2f spawnPos = enemy->getPosition();
-                    
-                    PowerUp::Type type = (rand() % 100 < 80) ? 
-                        PowerUp::Type::Small : PowerUp::Type::Large;
-                    powerUps.push_back(make_unique<PowerUp>(spawnPos, type));
-                }
-            }
+        // A netplay game is only over once no rollback can undo it.
+        if (world.isGameOver() && !isGameOver && (!netplay || net.isConfirmed(world))) {
+            isGameOver = true;
+            fadeAlpha = 0.0f;
         }
 
-        for (auto& powerUp : powerUps) {
-            if (powerUp->isActive() && player.getBounds().intersects(powerUp->getBounds())) {
-                powerUpSound.play();
-                powerUp->setActive(false);
-                int oldPower = player.getPowerLevel();
-                player.increasePower(powerUp->getType() == PowerUp::Type::Small ? 1 : 3);
-                
-                powerUp->handleFullPower(&player); 
-
-                player.addScore(50); 
-
-                if (player.getScore() % 1500 == 0) {
-                    player.addLife(); 
-                    extendSound.play(); 
-                    isShowingLifeUp = true; 
-                    lifeUpTimer = 0.0f; 
-                }
-
-                if (oldPower < Player::MAX_POWER && player.getPowerLevel() >= Player::MAX_POWER) {
-                    isShowingFullPower = true;
-                    fullPowerTimer = 0.0f;
-                    fullPowerSound.play();  
-                }
-            }
+        const Player& player = world.getPlayer(localPlayer);
+        // Text rebuilds its glyphs on every setString, so only touch the
+        // counters that actually changed this tick.
+        if (player.getScore() != shownScore) {
+            shownScore = player.getScore();
+            setCounterText(scoreText, scoreString, frameArena.format("Score: %d", shownScore));
         }
-
-        powerUps.erase(
-            remove_if(powerUps.begin(), powerUps.end(),
-                [](const auto& powerUp) { return !powerUp->isActive(); }),
-            powerUps.end()
-        );
-
-        for (auto& enemy : enemies) {
-            if (enemy->canShoot() && !enemy->hasShot) {
-                enemyShootSound.play();
-                enemy->hasShot = true;  
-                
-                for (int i = 0; i < Enemy::BURST_SIZE; i++) {
-
-                    float angle = -30.0f + (60.0f * i / (Enemy::BURST_SIZE - 1));
-                    float radians = angle * 3.14159f / 180.0f;
-                    
-                    Vector2f direction(
-                        sin(radians),  
-                        cos(radians) 
-                    );
-                    
-                    enemyBullets.push_back(make_unique<EnemyBullet>(
-                        enemy->getPosition(),
-                        direction * 150.0f  
-                    ));
-                }
-            }
+        if (player.getLives() != shownLives) {
+            shownLives = player.getLives();
+            setCounterText(livesText, livesString, frameArena.format("Chin: %d", shownLives));
         }
-
-        for (auto& bullet : enemyBullets) {
-            bullet->update(deltaTime);
+        if (player.getPowerLevel() != shownPower) {
+            shownPower = player.getPowerLevel();
+            setCounterText(powerText, powerString, shownPower >= Player::MAX_POWER ?
+                "FULL POWER" :
+                frameArena.format("Power: %d", shownPower));
         }
-
-        enemyBullets.erase(
-            remove_if(enemyBullets.begin(), enemyBullets.end(),
-                [](const auto& bullet) { return !bullet->isActive(); }),
-            enemyBullets.end()
-        );
-
-        for (const auto& bullet : enemyBullets) {
-            if (!player.isInvincible() && player.getBounds().intersects(bullet->getBounds())) {
-                deathSound.play();
-                player.hit();
-                bullet->setActive(false);
-                player.setPosition(Vector2f(GAME_X + GAME_SIZE/2, 550)); 
-                if (player.getLives() <= 0) {
-                    if (!isGameOver) {
-                        isGameOver = true;
-                        fadeAlpha = 0.0f;
-                    }
-                }
-            }
+        if (player.getBombs() != shownBombs) {
+            shownBombs = player.getBombs();
+            setCounterText(bombText, bombString, frameArena.format("Bombs: %d", shownBombs));
         }
-
-        for (const auto& car : cars) {
-            if (!player.isInvincible() && player.getBounds().intersects(car->getBounds())) {
-                deathSound.play();
-                player.hit();
-                player.setPosition(Vector2f(GAME_X + GAME_SIZE/2, 550)); 
-                if (player.getLives() <= 0) {
-                    if (!isGameOver) {
-                        isGameOver = true; 
-                        fadeAlpha = 0.0f; 
-                    }
-                }
+        const bool coop = world.getPlayerCount() > 1;
+        if (coop) {
+            size_t partnerIndex = localPlayer == 0 ? 1 : 0;
+            const Player& partner = world.getPlayer(partnerIndex);
+            if (partner.getScore() != shownPartnerScore || partner.getLives() != shownPartnerLives) {
+                shownPartnerScore = partner.getScore();
+                shownPartnerLives = partner.getLives();
+                setCounterText(partnerText, partnerString, frameArena.format("P%d %d  Chin: %d",
+                    static_cast<int>(partnerIndex) + 1, shownPartnerScore, shownPartnerLives));
             }
         }
 
-        cars.erase(
-            remove_if(cars.begin(), cars.end(),
-                [](const auto& car) { return !car->isActive(); }),
-            cars.end()
-        );
-
-        scoreText.setString("Score: " + to_string(player.getScore()));
-        livesText.setString("Chin: " + to_string(player.getLives()));
-        powerText.setString(player.getPowerLevel() >= Player::MAX_POWER ? 
-            "FULL POWER" : 
-            "Power: " + to_string(player.getPowerLevel()));
-        bombText.setString("Bombs: " + to_string(player.getBombs())); 
+        double simMs = benchmarkClock.restart().asMicroseconds() / 1000.0;
+        MemoryTracker::setThreadTag(MemoryTag::UI);
 
-        window.clear(Color::Black);
-
-        window.draw(topBorder);
-        window.draw(bottomBorder);
-        window.draw(leftBorder);
+        target.clear(Color::Black);
 
-        window.draw(backgroundSprite);
+        target.draw(topBorder);
+        target.draw(bottomBorder);
+        target.draw(leftBorder);
 
-        View gameView(FloatRect(0, 0, GAME_SIZE, GAME_SIZE));
-        gameView.setViewport(FloatRect(
-            0,
-            0,
-            0.75f,
-            1.0f
-        ));
-        window.setView(gameView);
-        
-        player.draw(window);
-        if (player.isInDeathAnimation()) {
-            player.updateDeathAnimation(deltaTime);
-            player.drawDeathAnimation(window);
-        }
-        for (auto& bullet : bullets) {
-            bullet->draw(window);
-        }
-        for (auto& enemy : enemies) {
-            if (enemy->isActive() || enemy->isInDeathAnimation()) {
-                enemy->draw(window);
-                if (enemy->isInDeathAnimation()) {
-                    enemy->updateDeathAnimation(deltaTime);
-                    enemy->drawDeathAnimation(window);
-                }
-            }
-        }
-        for (auto& powerUp : powerUps) {
-            powerUp->draw(window);
-        }
-        for (auto& bullet : enemyBullets) {
-            bullet->draw(window);
-        }
-        for (auto& car : cars) {
-            car->draw(window);
-        }
+        target.draw(backgroundSprite);
 
-        window.setView(window.getDefaultView());
+        DrawDetail detail;
+        detail.explosions = governor.isEnabled(QualityGovernor::Feature::Explosions);
+        detail.powerUpSpin = governor.isEnabled(QualityGovernor::Feature::PowerUpSpin);
+        target.setView(gameView);
+        world.draw(target, detail);
+        target.setView(target.getDefaultView());
         
         hudBackground.setSize(Vector2f(WINDOW_WIDTH * 0.25f, WINDOW_HEIGHT));
         hudBackground.setPosition(WINDOW_WIDTH * 0.75f, 0);
-        window.draw(hudBackground);
+        target.draw(hudBackground);
 
         const float HUD_X = WINDOW_WIDTH * 0.75f + 20; 
         highScoreText.setPosition(HUD_X, 10);
@@ -682,14 +1015,22 @@ int main() {
         livesText.setPosition(HUD_X, 90);
         powerText.setPosition(HUD_X, 130);
         bombText.setPosition(HUD_X, 170);
+        partnerText.setPosition(HUD_X, 210);
 
         if (gameState != GameState::Menu) {
-            window.draw(highScoreText);
-            window.draw(scoreText);
-            window.draw(livesText);
-            window.draw(powerText);
-            window.draw(bombText); 
-            window.draw(logoSprite); 
+            target.draw(highScoreText);
+            target.draw(scoreText);
+            target.draw(livesText);
+            target.draw(powerText);
+            target.draw(bombText); 
+            if (coop) {
+                target.draw(partnerText);
+            }
+            target.draw(logoSprite); 
+        }
+
+        if (showFrameStats) {
+            target.draw(frameStatsText);
         }
 
         if (isShowingFullPower) {
@@ -715,14 +1056,14 @@ int main() {
         }
 
         if (isShowingFullPower) {
-            View currentView = window.getView();
-            window.setView(gameView);
-            window.draw(fullPowerText);
-            window.setView(currentView);
+            View currentView = target.getView();
+            target.setView(gameView);
+            target.draw(fullPowerText);
+            target.setView(currentView);
         }
 
         if (isShowingLifeUp) {
-            window.draw(lifeUpText);
+            target.draw(lifeUpText);
         }
 
         if (isGameOver) {
@@ -730,31 +1071,162 @@ int main() {
             if (fadeAlpha >= 255.0f) {
                 fadeAlpha = 255.0f;
                 gameState = GameState::Menu;
-                player.reset(Vector2f(GAME_X + GAME_SIZE / 2, 550)); 
-                bullets.clear();
-                enemies.clear();
-                powerUps.clear();
-                cars.clear();
-                enemyBullets.clear();
+                music.play("title");
+                if (recording) {
+                    replay.saveToFile(options.recordPath);
+                }
+                if (replaying || netplay) {
+                    break;
+                }
+                world.reset();
                 highScoreText.setString("HS: " + to_string(highScore));
                 isGameOver = false; 
                 
                 backgroundTexture = loadRandomBackground(); 
                 backgroundSprite.setTexture(backgroundTexture); 
+                MemoryTracker::trackTexture(MemoryTag::UI, backgroundTexture);
             }
         }
         if (isGameOver) {
-            RectangleShape fadeOverlay(Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
             fadeOverlay.setFillColor(Color(0, 0, 0, fadeAlpha)); 
-            window.draw(fadeOverlay); 
+            target.draw(fadeOverlay); 
 
             gameOverSprite.setScale(
                 WINDOW_WIDTH / gameOverTexture.getSize().x,
                 WINDOW_HEIGHT / gameOverTexture.getSize().y
             );
-            window.draw(gameOverSprite); 
+            target.draw(gameOverSprite); 
+        }
+        // Measured before presenting, which may wait for the frame deadline.
+        double workMs = simMs + benchmarkClock.getElapsedTime().asMicroseconds() / 1000.0;
+        if (options.offscreen) {
+            canvas.display();
+        } else {
+            pacer.display(window);
+        }
+        double drawMs = benchmarkClock.getElapsedTime().asMicroseconds() / 1000.0;
+        // Dumped after timing, so the readback and PNG encode stay out of
+        // the draw figures.
+        if (options.offscreen && options.dumpEvery > 0 && frameNumber % options.dumpEvery == 0) {
+            ostringstream framePath;
+            framePath << options.dumpDir << "/frame_" << setw(6) << setfill('0') << frameNumber << ".png";
+            if (!canvas.getTexture().copyToImage().saveToFile(framePath.str())) {
+                cerr << "Error writing frame dump: " << framePath.str() << endl;
+            }
+        }
+        totalSimMs += simMs;
+        totalDrawMs += drawMs;
+        maxDrawMs = max(maxDrawMs, drawMs);
+        frameNumber++;
+        frameArena.reset();
+
+        governor.recordFrame(static_cast<float>(workMs));
+        if (governor.hasChanged()) {
+            applyHudQuality();
+        }
+
+        if (options.soakReportEvery > 0) {
+            soakSimMs += simMs;
+            soakDrawMs += drawMs;
+            soakMaxFrameMs = max(soakMaxFrameMs, simMs + drawMs);
+            if (frameNumber % options.soakReportEvery == 0) {
+                size_t liveBytes = 0;
+                for (size_t i = 0; i < MEMORY_TAG_COUNT; i++) {
+                    liveBytes += MemoryTracker::usage(static_cast<MemoryTag>(i)).liveBytes;
+                }
+                size_t allocations = MemoryTracker::totalAllocations();
+                cout << fixed << setprecision(3)
+                     << "soak: frame " << frameNumber << " game " << gamesStarted << " tick " << world.getTick()
+                     << ", sim " << soakSimMs / options.soakReportEvery << " ms"
+                     << ", draw " << soakDrawMs / options.soakReportEvery << " ms"
+                     << ", worst frame " << soakMaxFrameMs << " ms"
+                     << ", live " << liveBytes / 1024 << "K"
+                     << ", allocs/frame " << double(allocations - soakStartAllocations) / options.soakReportEvery
+                     << ", arena " << frameArena.getCapacity() / 1024 << "K"
+                     << ", bullets " << world.getBulletCount() << " + " << world.getEnemyBullets().size()
+                     << " enemy, enemies " << world.getEnemies().size() << ", cars " << world.getCars().size()
+                     << ", power-ups " << world.getPowerUpCount()
+                     << ", dropped events " << world.getDroppedEvents()
+                     << ", dropped sounds " << audio.getDroppedCommands()
+                     << ", quality " << governor.getLevel() << endl;
+                soakSimMs = 0.0;
+                soakDrawMs = 0.0;
+                soakMaxFrameMs = 0.0;
+                soakStartAllocations = allocations;
+            }
+        }
+
+        if (pacer.hasNewStats()) {
+            const FramePacer::Stats& stats = pacer.getStats();
+            ostringstream statsLine;
+            statsLine << fixed << setprecision(2)
+                      << FramePacer::modeName(pacer.getMode()) << " " << stats.fps << " fps\n"
+                      << "frame " << stats.avgFrameMs << " ms\n"
+                      << "jitter " << stats.avgJitterMs << " / " << stats.maxJitterMs << " ms\n";
+            size_t allocations = MemoryTracker::totalAllocations();
+            size_t statsFrames = max<size_t>(1, frameNumber - statsStartFrame);
+            statsLine << setprecision(1)
+                      << "allocs/frame " << double(allocations - statsStartAllocations) / statsFrames;
+            for (size_t i = 0; i < MEMORY_TAG_COUNT; i++) {
+                MemoryTag tag = static_cast<MemoryTag>(i);
+                MemoryUsage usage = MemoryTracker::usage(tag);
+                statsLine << "\n" << MemoryTracker::tagName(tag) << " " << usage.liveBytes / 1024
+                          << "K + gpu " << usage.textureBytes / 1024 << "K";
+            }
+            statsLine << "\narena peak " << frameArena.getPeak() / 1024
+                      << "K of " << frameArena.getCapacity() / 1024 << "K"
+                      << "\n" << governor.describe();
+            if (netplay) {
+                const NetSession::Stats& netStats = net.getStats();
+                statsLine << "\nnet ahead " << net.getPredictedTicks(world)
+                          << ", rollbacks " << netStats.rollbacks
+                          << "\nrollback last " << netStats.lastRollbackTicks << " in " << netStats.lastRollbackMs
+                          << " ms, max " << netStats.maxRollbackTicks << " in " << netStats.maxRollbackMs << " ms";
+                if (netStats.desynced) {
+                    statsLine << "\nDESYNC at tick " << netStats.desyncTick;
+                }
+            }
+            statsStartFrame = frameNumber;
+            statsStartAllocations = allocations;
+            frameStatsText.setString(statsLine.str());
+            if (pacer.getMode() == FramePacer::Mode::Uncapped) {
+                cout << "fps " << stats.fps << " frame " << stats.avgFrameMs << " ms" << endl;
+            }
         }
-        window.display();
+    }
+
+    if (recording && gameState == GameState::Playing) {
+        replay.saveToFile(options.recordPath);
+    }
+    if (replaying) {
+        cout << "replay: " << replay.getVerifiedTicks() << " ticks matched, "
+             << replay.getMismatchCount() << " diverged" << endl;
+    }
+    if (netplay) {
+        net.linger(seconds(2));
+        const NetSession::Stats& netStats = net.getStats();
+        cout << fixed << setprecision(3)
+             << "netplay: " << world.getTick() << " ticks, "
+             << netStats.rollbacks << " rollbacks re-simulating " << netStats.resimulatedTicks << " ticks"
+             << ", longest " << netStats.maxRollbackTicks << " ticks in " << netStats.maxRollbackMs << " ms"
+             << ", " << netStats.stalledFrames << " stalled frames"
+             << ", packets " << netStats.packetsSent << " sent / " << netStats.packetsLost << " lost / "
+             << netStats.packetsReceived << " received"
+             << (netStats.desynced ? ", DESYNCED" : ", in sync") << endl;
+    }
+
+    if (options.autoplay) {
+        cout << "autoplay: " << gamesStarted << " games, " << pilot.getBombsUsed() << " bombs used" << endl;
+    }
+
+    if (autoStart && frameNumber > 0) {
+        cout << fixed << setprecision(3)
+             << "benchmark: " << frameNumber << " frames"
+             << ", sim avg " << totalSimMs / frameNumber << " ms"
+             << ", draw avg " << totalDrawMs / frameNumber << " ms"
+             << ", draw max " << maxDrawMs << " ms"
+             << ", allocs/frame " << double(MemoryTracker::totalAllocations() - benchmarkStartAllocations) / frameNumber << endl;
+        MemoryTracker::print(cout);
     }
     return 0;
 }
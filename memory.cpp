@@ -0,0 +1,147 @@
+#include "memory.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+
+using namespace std;
+using namespace sf;
+
+namespace {
+
+struct alignas(alignof(max_align_t)) AllocationHeader {
+    size_t size;
+    MemoryTag tag;
+};
+
+// Zero-initialised before any dynamic initialiser runs, so allocations made
+// during static construction are counted too.
+atomic<size_t> liveBytes[MEMORY_TAG_COUNT];
+atomic<size_t> liveAllocations[MEMORY_TAG_COUNT];
+atomic<size_t> totalAllocationCounts[MEMORY_TAG_COUNT];
+thread_local MemoryTag currentTag = MemoryTag::General;
+
+struct TrackedTexture {
+    MemoryTag tag;
+    size_t bytes;
+};
+
+mutex& textureMutex() {
+    static mutex instance;
+    return instance;
+}
+
+map<const Texture*, TrackedTexture>& trackedTextures() {
+    static map<const Texture*, TrackedTexture> instance;
+    return instance;
+}
+
+void* trackedAllocate(size_t size) noexcept {
+    void* block = malloc(sizeof(AllocationHeader) + size);
+    if (!block) return nullptr;
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(block);
+    header->size = size;
+    header->tag = currentTag;
+    size_t tag = static_cast<size_t>(header->tag);
+    liveBytes[tag].fetch_add(size, memory_order_relaxed);
+    liveAllocations[tag].fetch_add(1, memory_order_relaxed);
+    totalAllocationCounts[tag].fetch_add(1, memory_order_relaxed);
+    return header + 1;
+}
+
+void trackedFree(void* pointer) noexcept {
+    if (!pointer) return;
+
+    AllocationHeader* header = static_cast<AllocationHeader*>(pointer) - 1;
+    size_t tag = static_cast<size_t>(header->tag);
+    liveBytes[tag].fetch_sub(header->size, memory_order_relaxed);
+    liveAllocations[tag].fetch_sub(1, memory_order_relaxed);
+    free(header);
+}
+
+void* allocateOrThrow(size_t size) {
+    void* pointer = trackedAllocate(size == 0 ? 1 : size);
+    if (!pointer) throw bad_alloc();
+    return pointer;
+}
+
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return trackedAllocate(size == 0 ? 1 : size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return trackedAllocate(size == 0 ? 1 : size); }
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, const nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, const nothrow_t&) noexcept { trackedFree(pointer); }
+
+MemoryTag MemoryTracker::setThreadTag(MemoryTag tag) {
+    MemoryTag previous = currentTag;
+    currentTag = tag;
+    return previous;
+}
+
+MemoryUsage MemoryTracker::usage(MemoryTag tag) {
+    size_t index = static_cast<size_t>(tag);
+    MemoryUsage result;
+    result.liveBytes = liveBytes[index].load(memory_order_relaxed);
+    result.liveAllocations = liveAllocations[index].load(memory_order_relaxed);
+    result.totalAllocations = totalAllocationCounts[index].load(memory_order_relaxed);
+
+    lock_guard<mutex> lock(textureMutex());
+    for (const auto& entry : trackedTextures()) {
+        if (entry.second.tag == tag) {
+            result.textureBytes += entry.second.bytes;
+        }
+    }
+    return result;
+}
+
+size_t MemoryTracker::totalAllocations() {
+    size_t total = 0;
+    for (size_t i = 0; i < MEMORY_TAG_COUNT; i++) {
+        total += totalAllocationCounts[i].load(memory_order_relaxed);
+    }
+    return total;
+}
+
+void MemoryTracker::trackTexture(MemoryTag tag, const Texture& texture) {
+    Vector2u size = texture.getSize();
+    lock_guard<mutex> lock(textureMutex());
+    trackedTextures()[&texture] = {tag, static_cast<size_t>(size.x) * size.y * 4};
+}
+
+void MemoryTracker::untrackTexture(const Texture& texture) {
+    lock_guard<mutex> lock(textureMutex());
+    trackedTextures().erase(&texture);
+}
+
+const char* MemoryTracker::tagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::General: return "general";
+        case MemoryTag::Entities: return "entities";
+        case MemoryTag::Assets: return "assets";
+        case MemoryTag::Audio: return "audio";
+        case MemoryTag::UI: return "ui";
+    }
+    return "unknown";
+}
+
+void MemoryTracker::print(ostream& out) {
+    out << "memory:" << endl;
+    for (size_t i = 0; i < MEMORY_TAG_COUNT; i++) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        MemoryUsage tagUsage = usage(tag);
+        out << "  " << left << setw(9) << tagName(tag) << right
+            << " heap " << setw(8) << tagUsage.liveBytes / 1024 << " KB"
+            << " in " << setw(6) << tagUsage.liveAllocations << " blocks"
+            << ", " << setw(8) << tagUsage.totalAllocations << " allocations"
+            << ", textures " << setw(6) << tagUsage.textureBytes / 1024 << " KB" << endl;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <ostream>
+
+using namespace std;
+using namespace sf;
+
+// Subsystems heap allocations and GPU textures are charged to.
+enum class MemoryTag : Uint8 {
+    General,
+    Entities,
+    Assets,
+    Audio,
+    UI
+};
+
+const size_t MEMORY_TAG_COUNT = 5;
+
+struct MemoryUsage {
+    size_t liveBytes = 0;
+    size_t liveAllocations = 0;
+    size_t totalAllocations = 0;
+    // Estimated as width * height * 4 for every tracked texture.
+    size_t textureBytes = 0;
+};
+
+// Every global operator new is counted against the calling thread's current
+// tag; each block remembers its tag so the matching delete is credited back
+// to the same subsystem.
+class MemoryTracker {
+public:
+    static MemoryTag setThreadTag(MemoryTag tag);
+    static MemoryUsage usage(MemoryTag tag);
+    static size_t totalAllocations();
+
+    // Textures are keyed by address, so reloading into the same Texture
+    // replaces its previous estimate instead of adding to it.
+    static void trackTexture(MemoryTag tag, const Texture& texture);
+    static void untrackTexture(const Texture& texture);
+
+    static const char* tagName(MemoryTag tag);
+    static void print(ostream& out);
+};
+
+class MemoryScope {
+public:
+    explicit MemoryScope(MemoryTag tag) : previous(MemoryTracker::setThreadTag(tag)) {}
+    ~MemoryScope() { MemoryTracker::setThreadTag(previous); }
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryTag previous;
+};
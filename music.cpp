@@ -0,0 +1,176 @@
+#include "music.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace sf;
+
+bool MusicTrack::open(const string& path, Mode mode, Uint64 loopStartFrame, Uint64 loopEndFrame, size_t bufferFrames) {
+    if (!file.openFromFile(path)) {
+        return false;
+    }
+    this->mode = mode;
+    this->bufferFrames = bufferFrames;
+    channels = file.getChannelCount();
+    sampleRate = file.getSampleRate();
+
+    Uint64 frameCount = file.getSampleCount() / channels;
+    loopEnd = loopEndFrame == 0 ? frameCount : min(loopEndFrame, frameCount);
+    loopStart = loopStartFrame;
+    if (loopEnd == 0) {
+        cerr << "Music track has no samples: " << path << endl;
+        return false;
+    }
+    // An empty loop would hand out nothing and stop the track for good.
+    if (loopStart >= loopEnd) {
+        cerr << "Music loop start " << loopStart << " is not before its end " << loopEnd << ": " << path << endl;
+        return false;
+    }
+    position = 0;
+
+    if (mode == Mode::Memory) {
+        pcm.resize(static_cast<size_t>(loopEnd * channels));
+        Uint64 read = file.read(pcm.data(), pcm.size());
+        if (read < pcm.size()) {
+            loopEnd = read / channels;
+            pcm.resize(static_cast<size_t>(loopEnd * channels));
+        }
+        if (loopStart >= loopEnd) {
+            cerr << "Music track decoded short of its loop (" << loopEnd << " frames): " << path << endl;
+            return false;
+        }
+        buffer.clear();
+    } else {
+        buffer.resize(bufferFrames * channels);
+        pcm.clear();
+    }
+    initialize(channels, sampleRate);
+    return true;
+}
+
+bool MusicTrack::onGetData(Chunk& data) {
+    if (mode == Mode::Memory) {
+        // Hand out slices of the decoded track directly; a slice stops at the
+        // loop end and the next one starts at the loop start.
+        if (position >= loopEnd) {
+            position = loopStart;
+        }
+        Uint64 frames = min<Uint64>(bufferFrames, loopEnd - position);
+        data.samples = pcm.data() + static_cast<size_t>(position * channels);
+        data.sampleCount = static_cast<size_t>(frames * channels);
+        position += frames;
+        return frames > 0;
+    }
+
+    size_t filled = 0;
+    while (filled < bufferFrames) {
+        if (position >= loopEnd) {
+            position = loopStart;
+            file.seek(loopStart * channels);
+        }
+        Uint64 wanted = min<Uint64>(bufferFrames - filled, loopEnd - position);
+        Uint64 read = file.read(&buffer[filled * channels], wanted * channels) / channels;
+        if (read == 0) {
+            break;
+        }
+        filled += static_cast<size_t>(read);
+        position += read;
+    }
+    data.samples = buffer.data();
+    data.sampleCount = filled * channels;
+    return filled > 0;
+}
+
+void MusicTrack::onSeek(Time timeOffset) {
+    Uint64 frame = static_cast<Uint64>(timeOffset.asMicroseconds()) * sampleRate / 1000000;
+    position = min(frame, loopEnd);
+    if (mode == Mode::Stream) {
+        file.seek(position * channels);
+    }
+}
+
+MusicPlayer::MusicPlayer(size_t streamBufferFrames) : streamBufferFrames(streamBufferFrames) {}
+
+bool MusicPlayer::loadPlaylist(const string& path) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Error opening music playlist: " << path << endl;
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        istringstream fields(line);
+        string stage;
+        string modeName;
+        string trackPath;
+        if (!(fields >> stage >> modeName >> trackPath)) {
+            cerr << path << ":" << lineNumber << ": expected '<stage> <memory|stream> <file>'" << endl;
+            return false;
+        }
+        MusicTrack::Mode mode;
+        if (modeName == "memory") {
+            mode = MusicTrack::Mode::Memory;
+        } else if (modeName == "stream") {
+            mode = MusicTrack::Mode::Stream;
+        } else {
+            cerr << path << ":" << lineNumber << ": unknown mode '" << modeName << "'" << endl;
+            return false;
+        }
+        Uint64 loopStart = 0;
+        Uint64 loopEnd = 0;
+        fields >> loopStart >> loopEnd;
+
+        auto track = make_unique<MusicTrack>();
+        if (!track->open(trackPath, mode, loopStart, loopEnd, streamBufferFrames)) {
+            cerr << "Error loading music track for stage '" << stage << "': " << trackPath << endl;
+            continue;
+        }
+        track->setVolume(volume);
+        tracks[stage] = move(track);
+    }
+    return true;
+}
+
+void MusicPlayer::play(const string& stage) {
+    if (stage == currentStage) {
+        return;
+    }
+    stop();
+    currentStage = stage;
+    auto found = tracks.find(stage);
+    if (found == tracks.end()) {
+        return;
+    }
+    current = found->second.get();
+    current->play();
+}
+
+void MusicPlayer::stop() {
+    if (current) {
+        current->stop();
+        current = nullptr;
+    }
+    currentStage.clear();
+}
+
+void MusicPlayer::setVolume(float volume) {
+    this->volume = volume;
+    for (auto& entry : tracks) {
+        entry.second->setVolume(volume);
+    }
+}
+
+size_t MusicPlayer::getResidentBytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : tracks) {
+        bytes += entry.second->getResidentBytes();
+    }
+    return bytes;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace sf;
+
+// A looping background track. Memory tracks are decoded to PCM once when
+// opened; Stream tracks keep the file open and decode one buffer at a time.
+// Either way the loop wraps inside onGetData, so the seam is sample-exact
+// and never waits on a reopen.
+class MusicTrack : public SoundStream {
+public:
+    enum class Mode {
+        Memory,
+        Stream
+    };
+
+    // Loop points are in sample frames; a loop end of 0 means the end of the file.
+    bool open(const string& path, Mode mode, Uint64 loopStartFrame, Uint64 loopEndFrame, size_t bufferFrames);
+    size_t getResidentBytes() const { return (pcm.capacity() + buffer.capacity()) * sizeof(Int16); }
+
+protected:
+    bool onGetData(Chunk& data) override;
+    void onSeek(Time timeOffset) override;
+
+private:
+    Mode mode = Mode::Memory;
+    InputSoundFile file;
+    vector<Int16> pcm;
+    vector<Int16> buffer;
+    unsigned channels = 0;
+    unsigned sampleRate = 0;
+    Uint64 loopStart = 0;
+    Uint64 loopEnd = 0;
+    Uint64 position = 0;
+    size_t bufferFrames = 0;
+};
+
+// Maps stage names to tracks and keeps exactly one of them playing.
+class MusicPlayer {
+public:
+    static constexpr size_t DEFAULT_BUFFER_FRAMES = 8192;
+
+    explicit MusicPlayer(size_t streamBufferFrames = DEFAULT_BUFFER_FRAMES);
+
+    // Lines are "<stage> <memory|stream> <file> [<loop start> <loop end>]".
+    // Tracks that fail to open are reported and left out, so their stage is silent.
+    bool loadPlaylist(const string& path);
+    // Does nothing if the stage is already playing.
+    void play(const string& stage);
+    void stop();
+    void setVolume(float volume);
+    size_t getResidentBytes() const;
+
+private:
+    size_t streamBufferFrames;
+    map<string, unique_ptr<MusicTrack>> tracks;
+    MusicTrack* current = nullptr;
+    string currentStage;
+    float volume = 100.0f;
+};
@@ -0,0 +1,250 @@
+#include "netplay.hpp"
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+
+using namespace std;
+using namespace sf;
+
+namespace {
+
+const Uint32 PACKET_MAGIC = 0x484B3931;  // "HK91"
+
+}
+
+NetSession::NetSession() {
+    socket.setBlocking(false);
+}
+
+bool NetSession::open(unsigned short localPort, const IpAddress& peerAddress, unsigned short peerPort,
+                      size_t localPlayer, const NetConditions& conditions) {
+    static_assert(is_trivially_copyable<Packet>::value, "packets are sent as raw bytes");
+    if (socket.bind(localPort) != Socket::Done) {
+        cerr << "netplay: could not bind UDP port " << localPort << endl;
+        return false;
+    }
+    this->peerAddress = peerAddress;
+    this->peerPort = peerPort;
+    this->localPlayer = localPlayer;
+    this->conditions = conditions;
+    // Seeded per port so the two sides on one machine lose different packets.
+    lossRandom.setState(localPort);
+    return true;
+}
+
+Uint32 NetSession::getPredictedTicks(const World& world) const {
+    return world.getTick() > remoteTicks ? world.getTick() - remoteTicks : 0;
+}
+
+void NetSession::receive(World& world, float deltaTime, FrameArena& arena) {
+    Uint32 currentTick = world.getTick();
+    Uint32 rollbackTick = readPackets(currentTick);
+    if (rollbackTick < currentTick) {
+        Clock rollbackClock;
+        world.restore(saved[rollbackTick % MAX_ROLLBACK].snapshot);
+        // The snapshot being resumed from is still right; only later ones change.
+        bool save = false;
+        while (world.getTick() < currentTick) {
+            simulate(world, deltaTime, arena, save);
+            save = true;
+        }
+        Uint32 ticks = currentTick - rollbackTick;
+        stats.rollbacks++;
+        stats.resimulatedTicks += ticks;
+        stats.lastRollbackTicks = ticks;
+        stats.maxRollbackTicks = max(stats.maxRollbackTicks, ticks);
+        stats.lastRollbackMs = rollbackClock.getElapsedTime().asMicroseconds() / 1000.0f;
+        stats.maxRollbackMs = max(stats.maxRollbackMs, stats.lastRollbackMs);
+    }
+
+    // Ticks that were predicted correctly became final without being stepped
+    // again; their checksums were taken when they were saved.
+    while (nextCheckTick < currentTick && nextCheckTick <= remoteTicks) {
+        const SavedTick& entry = saved[nextCheckTick % MAX_ROLLBACK];
+        if (entry.tick == nextCheckTick) {
+            publishChecksum(nextCheckTick, entry.checksum);
+        } else {
+            nextCheckTick += CHECKSUM_INTERVAL;
+        }
+    }
+}
+
+const WorldEffects* NetSession::advance(World& world, const InputState& localInput, float deltaTime, FrameArena& arena) {
+    Uint32 tick = world.getTick();
+    if (tick >= remoteTicks + MAX_ROLLBACK || tick - peerAcked >= INPUT_HISTORY - MAX_ROLLBACK) {
+        stats.stalledFrames++;
+        return nullptr;
+    }
+    localInputs[tick % INPUT_HISTORY] = localInput;
+    localTicks = tick + 1;
+    return &simulate(world, deltaTime, arena, true);
+}
+
+const WorldEffects& NetSession::simulate(World& world, float deltaTime, FrameArena& arena, bool save) {
+    Uint32 tick = world.getTick();
+    bool checked = tick % CHECKSUM_INTERVAL == 0;
+    // Only ticks the peer has not confirmed yet can be rolled back to.
+    if (tick >= remoteTicks) {
+        SavedTick& entry = saved[tick % MAX_ROLLBACK];
+        if (save) {
+            world.save(entry.snapshot);
+            entry.tick = tick;
+            if (checked) {
+                entry.checksum = world.checksum();
+            }
+        }
+        if (checked && tick == remoteTicks) {
+            publishChecksum(tick, entry.checksum);
+        }
+    } else if (checked) {
+        publishChecksum(tick, world.checksum());
+    }
+
+    InputState remote;
+    if (tick < remoteTicks) {
+        remote = remoteInputs[tick % INPUT_HISTORY];
+    } else if (remoteTicks > 0) {
+        remote = remoteInputs[(remoteTicks - 1) % INPUT_HISTORY];
+    }
+    usedRemoteInputs[tick % INPUT_HISTORY] = remote;
+
+    PlayerInputs inputs;
+    inputs[localPlayer] = localInputs[tick % INPUT_HISTORY];
+    inputs[1 - localPlayer] = remote;
+    return world.step(inputs, deltaTime, arena);
+}
+
+Uint32 NetSession::readPackets(Uint32 currentTick) {
+    Uint32 rollbackTick = currentTick;
+    Packet packet;
+    size_t received = 0;
+    IpAddress sender;
+    unsigned short senderPort = 0;
+    while (socket.receive(&packet, sizeof(packet), received, sender, senderPort) == Socket::Done) {
+        if (received != sizeof(packet) || packet.magic != PACKET_MAGIC ||
+            sender != peerAddress || senderPort != peerPort || packet.count > MAX_PACKET_INPUTS) {
+            continue;
+        }
+        stats.packetsReceived++;
+        peerAcked = max(peerAcked, min(packet.ack, localTicks));
+
+        for (Uint32 i = 0; i < packet.count; i++) {
+            Uint32 tick = packet.firstTick + i;
+            // Older ticks are already known; anything past a gap waits for a resend.
+            if (tick != remoteTicks) continue;
+            // Ticks still needed for a rollback must not be overwritten.
+            if (tick >= currentTick + INPUT_HISTORY - MAX_ROLLBACK) break;
+            remoteInputs[tick % INPUT_HISTORY] = packet.inputs[i];
+            if (tick < currentTick && packet.inputs[i].buttons != usedRemoteInputs[tick % INPUT_HISTORY].buttons) {
+                rollbackTick = min(rollbackTick, tick);
+            }
+            remoteTicks++;
+        }
+
+        if (packet.hasChecksum) {
+            CheckedTick& check = remoteChecks[(packet.checksumTick / CHECKSUM_INTERVAL) % CHECKSUM_HISTORY];
+            check.tick = packet.checksumTick;
+            check.checksum = packet.checksum;
+            check.valid = true;
+            compareChecksums(packet.checksumTick);
+        }
+    }
+    return rollbackTick;
+}
+
+void NetSession::publishChecksum(Uint32 tick, const WorldChecksum& checksum) {
+    if (tick < nextCheckTick) return;
+    CheckedTick& check = localChecks[(tick / CHECKSUM_INTERVAL) % CHECKSUM_HISTORY];
+    check.tick = tick;
+    check.checksum = checksum;
+    check.valid = true;
+    lastPublished = check;
+    nextCheckTick = tick + CHECKSUM_INTERVAL;
+    compareChecksums(tick);
+}
+
+void NetSession::compareChecksums(Uint32 tick) {
+    size_t slot = (tick / CHECKSUM_INTERVAL) % CHECKSUM_HISTORY;
+    const CheckedTick& local = localChecks[slot];
+    const CheckedTick& remote = remoteChecks[slot];
+    if (!local.valid || !remote.valid || local.tick != tick || remote.tick != tick) {
+        return;
+    }
+    size_t part = local.checksum.firstDifference(remote.checksum);
+    if (part == WorldChecksum::PART_COUNT || stats.desynced) {
+        return;
+    }
+    stats.desynced = true;
+    stats.desyncTick = tick;
+    cerr << "netplay: desync at tick " << tick << " in";
+    for (; part < WorldChecksum::PART_COUNT; part++) {
+        if (local.checksum.parts[part] != remote.checksum.parts[part]) {
+            cerr << " " << WorldChecksum::partName(part);
+        }
+    }
+    cerr << endl;
+}
+
+void NetSession::send() {
+    Packet packet = {};
+    packet.magic = PACKET_MAGIC;
+    packet.firstTick = peerAcked;
+    packet.ack = remoteTicks;
+    packet.count = static_cast<Uint8>(min(localTicks - peerAcked, MAX_PACKET_INPUTS));
+    for (Uint32 i = 0; i < packet.count; i++) {
+        packet.inputs[i] = localInputs[(peerAcked + i) % INPUT_HISTORY];
+    }
+    if (lastPublished.valid) {
+        packet.hasChecksum = 1;
+        packet.checksumTick = lastPublished.tick;
+        packet.checksum = lastPublished.checksum;
+    }
+    transmit(packet);
+    flushDelayed(false);
+}
+
+void NetSession::transmit(const Packet& packet) {
+    if (conditions.lossPercent > 0.0f && lossRandom.nextInt(10000) < conditions.lossPercent * 100.0f) {
+        stats.packetsLost++;
+        return;
+    }
+    if (conditions.latencyMs <= 0) {
+        socket.send(&packet, sizeof(packet), peerAddress, peerPort);
+        stats.packetsSent++;
+        return;
+    }
+    // Sending the oldest early beats dropping it when the queue is full.
+    if (delayCount == DELAY_QUEUE_SIZE) {
+        const Packet& oldest = delayQueue[delayHead].packet;
+        socket.send(&oldest, sizeof(oldest), peerAddress, peerPort);
+        stats.packetsSent++;
+        delayHead = (delayHead + 1) % DELAY_QUEUE_SIZE;
+        delayCount--;
+    }
+    PendingPacket& pending = delayQueue[(delayHead + delayCount) % DELAY_QUEUE_SIZE];
+    pending.dueMicros = clock.getElapsedTime().asMicroseconds() + conditions.latencyMs * 1000;
+    pending.packet = packet;
+    delayCount++;
+}
+
+// Every datagram is delayed by the same amount, so the queue stays in due order.
+void NetSession::flushDelayed(bool all) {
+    Int64 now = clock.getElapsedTime().asMicroseconds();
+    while (delayCount > 0 && (all || delayQueue[delayHead].dueMicros <= now)) {
+        const Packet& packet = delayQueue[delayHead].packet;
+        socket.send(&packet, sizeof(packet), peerAddress, peerPort);
+        stats.packetsSent++;
+        delayHead = (delayHead + 1) % DELAY_QUEUE_SIZE;
+        delayCount--;
+    }
+}
+
+void NetSession::linger(Time timeout) {
+    Clock timer;
+    while (peerAcked < localTicks && timer.getElapsedTime() < timeout) {
+        readPackets(localTicks);
+        send();
+        sleep(milliseconds(5));
+    }
+    flushDelayed(true);
+}
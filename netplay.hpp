@@ -0,0 +1,152 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+#include "world.hpp"
+#include "random.hpp"
+
+using namespace std;
+using namespace sf;
+
+// Link conditions faked on everything this side sends, so two copies of the
+// game on one machine can play as if they were far apart. Each side applies
+// its own, so the round trip is the sum of both latencies.
+struct NetConditions {
+    Int32 latencyMs = 0;
+    float lossPercent = 0.0f;
+};
+
+// Two-player co-op over UDP with rollback. Each side owns one ship and sends
+// its inputs every frame; the other ship is predicted to keep holding what it
+// last confirmed. When the peer's real input for an already simulated tick
+// differs from the prediction, the world is restored from that tick's
+// snapshot and stepped forward again with the corrected inputs.
+//
+// Both sides must step with the same delta and start from the same seed.
+class NetSession {
+public:
+    // How far the world may run ahead of the peer's confirmed input. One
+    // snapshot is kept per tick of it, so this also bounds a rollback.
+    static constexpr Uint32 MAX_ROLLBACK = 16;
+    // Inputs kept for resending and for checking predictions.
+    static constexpr Uint32 INPUT_HISTORY = 256;
+    static constexpr Uint32 MAX_PACKET_INPUTS = 32;
+    // Confirmed world checksums are exchanged on ticks that are multiples of
+    // this, which catches a desync within half a second.
+    static constexpr Uint32 CHECKSUM_INTERVAL = 30;
+    static constexpr size_t CHECKSUM_HISTORY = 8;
+    static constexpr size_t DELAY_QUEUE_SIZE = 128;
+
+    struct Stats {
+        Uint32 rollbacks = 0;
+        Uint32 resimulatedTicks = 0;
+        Uint32 lastRollbackTicks = 0;
+        Uint32 maxRollbackTicks = 0;
+        float lastRollbackMs = 0.0f;
+        float maxRollbackMs = 0.0f;
+        Uint32 stalledFrames = 0;
+        Uint32 packetsSent = 0;
+        Uint32 packetsReceived = 0;
+        Uint32 packetsLost = 0;
+        bool desynced = false;
+        Uint32 desyncTick = 0;
+    };
+
+    NetSession();
+
+    // localPlayer is the ship this side controls; the peer controls the other.
+    bool open(unsigned short localPort, const IpAddress& peerAddress, unsigned short peerPort,
+              size_t localPlayer, const NetConditions& conditions);
+    size_t getLocalPlayer() const { return localPlayer; }
+
+    // Reads everything the peer has sent and rolls the world back and
+    // forward again if a prediction turned out wrong. Call once per frame
+    // before advance().
+    void receive(World& world, float deltaTime, FrameArena& arena);
+    // Steps the world one tick with the local input and the peer's known or
+    // predicted one. Returns null, without stepping, while the world is
+    // MAX_ROLLBACK ticks ahead of the peer.
+    const WorldEffects* advance(World& world, const InputState& localInput, float deltaTime, FrameArena& arena);
+    // Sends every input the peer has not acknowledged and releases delayed
+    // datagrams that are due. Call once per frame, stalled or not.
+    void send();
+    // Keeps resending until the peer has acknowledged every input, or the
+    // timeout passes, so it can still confirm the ticks this side ended on.
+    void linger(Time timeout);
+
+    // Every input before the world's tick is known, so nothing it shows can
+    // be rolled back any more.
+    bool isConfirmed(const World& world) const { return world.getTick() <= remoteTicks; }
+    Uint32 getPredictedTicks(const World& world) const;
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Sent whole every frame. Inputs start at the first tick the peer has
+    // not acknowledged, so a lost datagram is covered by the next one.
+    struct Packet {
+        Uint32 magic;
+        Uint32 firstTick;
+        // The sender has the receiver's inputs for every tick before this.
+        Uint32 ack;
+        Uint32 checksumTick;
+        WorldChecksum checksum;
+        Uint8 hasChecksum;
+        Uint8 count;
+        Uint8 reserved[2];
+        InputState inputs[MAX_PACKET_INPUTS];
+    };
+
+    struct PendingPacket {
+        Int64 dueMicros;
+        Packet packet;
+    };
+
+    struct SavedTick {
+        Uint32 tick = 0;
+        WorldSnapshot snapshot;
+        WorldChecksum checksum;
+    };
+
+    struct CheckedTick {
+        Uint32 tick = 0;
+        WorldChecksum checksum;
+        bool valid = false;
+    };
+
+    UdpSocket socket;
+    IpAddress peerAddress;
+    unsigned short peerPort = 0;
+    size_t localPlayer = 0;
+    NetConditions conditions;
+    Random lossRandom;
+    Clock clock;
+
+    InputState localInputs[INPUT_HISTORY];
+    InputState remoteInputs[INPUT_HISTORY];
+    // What each simulated tick used for the peer, to spot wrong predictions.
+    InputState usedRemoteInputs[INPUT_HISTORY];
+    Uint32 localTicks = 0;
+    // The peer's inputs are known for every tick before remoteTicks, and it
+    // has ours for every tick before peerAcked.
+    Uint32 remoteTicks = 0;
+    Uint32 peerAcked = 0;
+
+    SavedTick saved[MAX_ROLLBACK];
+    CheckedTick localChecks[CHECKSUM_HISTORY];
+    CheckedTick remoteChecks[CHECKSUM_HISTORY];
+    CheckedTick lastPublished;
+    Uint32 nextCheckTick = 0;
+
+    PendingPacket delayQueue[DELAY_QUEUE_SIZE];
+    size_t delayHead = 0;
+    size_t delayCount = 0;
+
+    Stats stats;
+
+    // Returns the earliest tick whose prediction was wrong, or currentTick.
+    Uint32 readPackets(Uint32 currentTick);
+    const WorldEffects& simulate(World& world, float deltaTime, FrameArena& arena, bool save);
+    void publishChecksum(Uint32 tick, const WorldChecksum& checksum);
+    void compareChecksums(Uint32 tick);
+    void transmit(const Packet& packet);
+    void flushDelayed(bool all);
+};
@@ -0,0 +1,106 @@
+#include "pacing.hpp"
+#include <cmath>
+#include <thread>
+
+using namespace std;
+using namespace sf;
+
+constexpr chrono::microseconds FramePacer::SPIN_MARGIN;
+
+FramePacer::FramePacer(Mode mode, float targetFps)
+    : mode(mode),
+      period(chrono::duration_cast<clock::duration>(chrono::duration<double>(1.0 / targetFps))) {}
+
+void FramePacer::apply(RenderWindow& window) {
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(mode == Mode::VSync);
+}
+
+void FramePacer::display(RenderWindow& window) {
+    window.display();
+    if (mode == Mode::Sleep) {
+        waitForDeadline();
+    }
+    recordFrame(clock::now());
+}
+
+void FramePacer::waitForDeadline() {
+    clock::time_point now = clock::now();
+    if (!started) {
+        nextDeadline = now;
+    }
+    nextDeadline += period;
+
+    // A frame that overran by more than a whole period starts a new schedule
+    // instead of rushing the following frames to catch up.
+    // Smaller overruns keep the schedule: the wait below falls straight
+    // through and the next frame gets its time back.
+    if (now > nextDeadline + period) {
+        nextDeadline = now;
+        return;
+    }
+
+    clock::duration remaining = nextDeadline - now;
+    if (remaining > SPIN_MARGIN) {
+        sf::sleep(microseconds(chrono::duration_cast<chrono::microseconds>(remaining - SPIN_MARGIN).count()));
+    }
+    while (clock::now() < nextDeadline) {
+        this_thread::yield();
+    }
+}
+
+void FramePacer::recordFrame(clock::time_point now) {
+    statsUpdated = false;
+    if (!started) {
+        started = true;
+        lastFrame = now;
+        return;
+    }
+
+    float frameMs = chrono::duration<float, milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    float jitterMs = 0.0f;
+    if (mode != Mode::Uncapped) {
+        jitterMs = fabs(frameMs - chrono::duration<float, milli>(period).count());
+    }
+    windowFrames++;
+    windowTime += frameMs / 1000.0f;
+    windowJitter += jitterMs;
+    windowMaxJitter = max(windowMaxJitter, jitterMs);
+
+    if (windowTime >= STATS_WINDOW) {
+        stats.fps = windowFrames / windowTime;
+        stats.avgFrameMs = windowTime * 1000.0f / windowFrames;
+        stats.avgJitterMs = windowJitter / windowFrames;
+        stats.maxJitterMs = windowMaxJitter;
+        statsUpdated = true;
+
+        windowFrames = 0;
+        windowTime = 0.0f;
+        windowJitter = 0.0f;
+        windowMaxJitter = 0.0f;
+    }
+}
+
+bool FramePacer::parseMode(const string& name, Mode& mode) {
+    if (name == "vsync") {
+        mode = Mode::VSync;
+    } else if (name == "sleep") {
+        mode = Mode::Sleep;
+    } else if (name == "uncapped") {
+        mode = Mode::Uncapped;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* FramePacer::modeName(Mode mode) {
+    switch (mode) {
+        case Mode::VSync: return "vsync";
+        case Mode::Sleep: return "sleep";
+        case Mode::Uncapped: return "uncapped";
+    }
+    return "unknown";
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <string>
+
+using namespace std;
+using namespace sf;
+
+class FramePacer {
+public:
+    enum class Mode {
+        VSync,
+        Sleep,
+        Uncapped
+    };
+
+    struct Stats {
+        float fps = 0.0f;
+        float avgFrameMs = 0.0f;
+        float avgJitterMs = 0.0f;
+        float maxJitterMs = 0.0f;
+    };
+
+    FramePacer(Mode mode, float targetFps);
+    void apply(RenderWindow& window);
+    // Presents the frame, then holds until the next frame deadline in Sleep mode.
+    void display(RenderWindow& window);
+    // True once per stats window, right after getStats() has been refreshed.
+    bool hasNewStats() const { return statsUpdated; }
+    const Stats& getStats() const { return stats; }
+    Mode getMode() const { return mode; }
+
+    static bool parseMode(const string& name, Mode& mode);
+    static const char* modeName(Mode mode);
+
+private:
+    using clock = chrono::steady_clock;
+
+    // Sleep mode hands control back to the OS until this close to the deadline,
+    // then spins; sleep granularity on desktop kernels is well above 1 ms.
+    static constexpr chrono::microseconds SPIN_MARGIN{2000};
+    static constexpr float STATS_WINDOW = 1.0f;
+
+    Mode mode;
+    clock::duration period;
+    clock::time_point nextDeadline;
+    clock::time_point lastFrame;
+    bool started = false;
+
+    Stats stats;
+    bool statsUpdated = false;
+    int windowFrames = 0;
+    float windowTime = 0.0f;
+    float windowJitter = 0.0f;
+    float windowMaxJitter = 0.0f;
+
+    void waitForDeadline();
+    void recordFrame(clock::time_point now);
+};
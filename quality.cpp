@@ -0,0 +1,67 @@
+#include "quality.hpp"
+#include <algorithm>
+
+using namespace std;
+using namespace sf;
+
+QualityGovernor::QualityGovernor(float budgetMs) : budgetMs(budgetMs) {}
+
+void QualityGovernor::pin(int level) {
+    this->level = max(0, min(level, MAX_LEVEL));
+    pinned = true;
+}
+
+void QualityGovernor::recordFrame(float workMs) {
+    changed = false;
+    if (pinned) return;
+
+    windowFrames++;
+    if (workMs > budgetMs) {
+        windowOverruns++;
+    }
+    windowWorstMs = max(windowWorstMs, workMs);
+    if (windowFrames < WINDOW_FRAMES) return;
+
+    // Restoring needs far more headroom than shedding tolerates, so a level
+    // that just fixed the overrun is not handed straight back.
+    if (windowOverruns >= SHED_OVERRUNS) {
+        calmWindows = 0;
+        if (level < MAX_LEVEL) {
+            level++;
+            changed = true;
+        }
+    } else if (windowWorstMs < budgetMs * RESTORE_HEADROOM) {
+        if (++calmWindows >= RESTORE_WINDOWS && level > 0) {
+            level--;
+            changed = true;
+            calmWindows = 0;
+        }
+    } else {
+        calmWindows = 0;
+    }
+    windowFrames = 0;
+    windowOverruns = 0;
+    windowWorstMs = 0.0f;
+}
+
+string QualityGovernor::describe() const {
+    string text = "quality " + to_string(level) + "/" + to_string(MAX_LEVEL);
+    if (pinned) {
+        text += " pinned";
+    }
+    for (int i = 0; i < level; i++) {
+        text += i == 0 ? ", off: " : ", ";
+        text += featureName(static_cast<Feature>(i));
+    }
+    return text;
+}
+
+const char* QualityGovernor::featureName(Feature feature) {
+    switch (feature) {
+        case Feature::HudOutlines: return "hud outlines";
+        case Feature::SoundRepeats: return "sound repeats";
+        case Feature::PowerUpSpin: return "power-up spin";
+        case Feature::Explosions: return "explosions";
+    }
+    return "unknown";
+}
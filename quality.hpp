@@ -0,0 +1,61 @@
+#pragma once
+#include <SFML/Config.hpp>
+#include <string>
+
+using namespace std;
+using namespace sf;
+
+// Trades cosmetic detail for frame time. Fed the CPU time of every frame,
+// it gives up one feature at a time while frames keep running over budget,
+// and takes them back one at a time once there is plenty of headroom again.
+// Nothing it switches off affects the simulation.
+class QualityGovernor {
+public:
+    // In the order they are given up: level N has the first N switched off.
+    enum class Feature : Uint8 {
+        HudOutlines,
+        SoundRepeats,
+        PowerUpSpin,
+        Explosions
+    };
+
+    static constexpr int FEATURE_COUNT = 4;
+    static constexpr int MAX_LEVEL = FEATURE_COUNT;
+    // Frames are judged in windows this long, so one hitch does not count.
+    static constexpr int WINDOW_FRAMES = 30;
+    // A window with this many frames over budget sheds a level.
+    static constexpr int SHED_OVERRUNS = 8;
+    // A level comes back after this many windows in a row whose slowest
+    // frame stayed under this fraction of the budget.
+    static constexpr int RESTORE_WINDOWS = 4;
+    static constexpr float RESTORE_HEADROOM = 0.6f;
+
+    explicit QualityGovernor(float budgetMs);
+
+    // Holds the level where it is; recordFrame stops changing it.
+    void pin(int level);
+    // Work done for the frame just finished, excluding any wait for the
+    // next frame deadline.
+    void recordFrame(float workMs);
+
+    int getLevel() const { return level; }
+    bool isEnabled(Feature feature) const { return static_cast<int>(feature) >= level; }
+    // True right after a recordFrame that changed the level.
+    bool hasChanged() const { return changed; }
+    float getBudgetMs() const { return budgetMs; }
+    // "quality 2/4, off: hud outlines, sound repeats"
+    string describe() const;
+
+    static const char* featureName(Feature feature);
+
+private:
+    float budgetMs;
+    int level = 0;
+    bool pinned = false;
+    bool changed = false;
+
+    int windowFrames = 0;
+    int windowOverruns = 0;
+    float windowWorstMs = 0.0f;
+    int calmWindows = 0;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <SFML/Config.hpp>
+
+using namespace sf;
+
+// xorshift64* generator for everything the simulation randomizes. Its whole
+// state is one integer, so snapshots can save and restore it exactly, which
+// the global rand() does not allow.
+class Random {
+public:
+    explicit Random(Uint64 seed = 1) { setState(seed); }
+
+    Uint32 next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<Uint32>((state * 2685821657736338717ULL) >> 32);
+    }
+    // Uniform enough for spawn rolls; bound must be positive.
+    int nextInt(int bound) { return static_cast<int>(next() % static_cast<Uint32>(bound)); }
+
+    Uint64 getState() const { return state; }
+    void setState(Uint64 value) { state = value ? value : 1; }
+
+private:
+    Uint64 state;
+};
@@ -0,0 +1,187 @@
+#include "replay.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+using namespace sf;
+
+namespace {
+
+const char REPLAY_MAGIC[8] = {'H', 'K', '9', '7', 'R', 'P', 'L', '6'};
+
+template<typename T>
+void writeValue(ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readValue(ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Bytes between the read position and the end of the file. Counts read from
+// a file are checked against this before anything is sized from them, so a
+// damaged header cannot ask for gigabytes.
+Uint64 remainingBytes(ifstream& file) {
+    streampos here = file.tellg();
+    file.seekg(0, ios::end);
+    streampos end = file.tellg();
+    file.seekg(here);
+    return end > here ? static_cast<Uint64>(end - here) : 0;
+}
+
+}
+
+void Replay::clear() {
+    frames.clear();
+    checksums.clear();
+    keyframes.clear();
+}
+
+void Replay::addFrame(const PlayerInputs& inputs, float deltaTime, const WorldChecksum& checksum) {
+    frames.push_back({inputs, {}, deltaTime});
+    checksums.push_back(checksum);
+}
+
+void Replay::addKeyframe(const World& world) {
+    while (!keyframes.empty() && keyframes.back().tick >= world.getTick()) {
+        keyframes.pop_back();
+    }
+    world.save(scratch);
+    keyframes.push_back({world.getTick(), {}});
+    scratch.serialize(keyframes.back().state);
+}
+
+void Replay::truncate(Uint32 tick) {
+    if (tick < frames.size()) {
+        frames.resize(tick);
+        checksums.resize(tick);
+    }
+    while (!keyframes.empty() && keyframes.back().tick > tick) {
+        keyframes.pop_back();
+    }
+}
+
+bool Replay::saveToFile(const string& path) const {
+    ofstream file(path, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error writing replay: " << path << endl;
+        return false;
+    }
+    file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    writeValue(file, static_cast<Uint32>(frames.size()));
+    file.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(Frame));
+    file.write(reinterpret_cast<const char*>(checksums.data()), checksums.size() * sizeof(WorldChecksum));
+    writeValue(file, static_cast<Uint32>(keyframes.size()));
+    for (const Keyframe& keyframe : keyframes) {
+        writeValue(file, keyframe.tick);
+        writeValue(file, static_cast<Uint32>(keyframe.state.size()));
+        file.write(reinterpret_cast<const char*>(keyframe.state.data()), keyframe.state.size());
+    }
+    return static_cast<bool>(file);
+}
+
+bool Replay::loadFromFile(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error opening replay: " << path << endl;
+        return false;
+    }
+    clear();
+
+    char magic[sizeof(REPLAY_MAGIC)];
+    Uint32 frameCount = 0;
+    if (!file.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), REPLAY_MAGIC) ||
+        !readValue(file, frameCount)) {
+        cerr << path << ": not a replay file" << endl;
+        return false;
+    }
+    if (static_cast<Uint64>(frameCount) * (sizeof(Frame) + sizeof(WorldChecksum)) > remainingBytes(file)) {
+        cerr << path << ": truncated replay" << endl;
+        return false;
+    }
+    frames.resize(frameCount);
+    checksums.resize(frameCount);
+    Uint32 keyframeCount = 0;
+    if (!file.read(reinterpret_cast<char*>(frames.data()), frameCount * sizeof(Frame)) ||
+        !file.read(reinterpret_cast<char*>(checksums.data()), frameCount * sizeof(WorldChecksum)) ||
+        !readValue(file, keyframeCount)) {
+        cerr << path << ": truncated replay" << endl;
+        return false;
+    }
+    // Every keyframe has at least its tick and size.
+    if (static_cast<Uint64>(keyframeCount) * 2 * sizeof(Uint32) > remainingBytes(file)) {
+        cerr << path << ": truncated replay" << endl;
+        return false;
+    }
+    keyframes.resize(keyframeCount);
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        Keyframe& keyframe = keyframes[i];
+        Uint32 size = 0;
+        if (!readValue(file, keyframe.tick) || !readValue(file, size) || size > remainingBytes(file)) {
+            cerr << path << ": truncated replay" << endl;
+            return false;
+        }
+        // seek() takes the last keyframe at or before a tick, so they must
+        // be in order and within the recording.
+        if (keyframe.tick > frameCount || (i > 0 && keyframe.tick <= keyframes[i - 1].tick)) {
+            cerr << path << ": keyframe at tick " << keyframe.tick << " is out of order or past the end" << endl;
+            return false;
+        }
+        keyframe.state.resize(size);
+        if (!file.read(reinterpret_cast<char*>(keyframe.state.data()), size)) {
+            cerr << path << ": truncated replay" << endl;
+            return false;
+        }
+    }
+    if (keyframes.empty() || keyframes.front().tick != 0) {
+        cerr << path << ": replay has no starting keyframe" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::seek(World& world, Uint32 tick, FrameArena& arena) {
+    const Keyframe* nearest = nullptr;
+    for (const Keyframe& keyframe : keyframes) {
+        if (keyframe.tick > tick) break;
+        nearest = &keyframe;
+    }
+    if (!nearest || !scratch.deserialize(nearest->state.data(), nearest->state.size())) {
+        return false;
+    }
+    world.restore(scratch);
+    for (Uint32 t = nearest->tick; t < tick && t < frames.size(); t++) {
+        verify(world);
+        world.step(frames[t].inputs, frames[t].deltaTime, arena);
+        arena.reset();
+    }
+    return true;
+}
+
+bool Replay::verify(const World& world) {
+    Uint32 tick = world.getTick();
+    if (tick >= checksums.size()) {
+        return true;
+    }
+    WorldChecksum actual = world.checksum();
+    size_t part = checksums[tick].firstDifference(actual);
+    if (part == WorldChecksum::PART_COUNT) {
+        verifiedTicks++;
+        return true;
+    }
+    if (mismatches == 0) {
+        cerr << "replay: diverged at tick " << tick << " in";
+        for (; part < WorldChecksum::PART_COUNT; part++) {
+            if (checksums[tick].parts[part] != actual.parts[part]) {
+                cerr << " " << WorldChecksum::partName(part) << hex
+                     << " (recorded " << checksums[tick].parts[part]
+                     << ", got " << actual.parts[part] << ")" << dec;
+            }
+        }
+        cerr << endl;
+    }
+    mismatches++;
+    return false;
+}
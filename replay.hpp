@@ -0,0 +1,65 @@
+#pragma once
+#include <SFML/Config.hpp>
+#include <string>
+#include <vector>
+#include "input.hpp"
+#include "world.hpp"
+
+using namespace std;
+using namespace sf;
+
+// A recorded game: every player's input, the step length and the world
+// checksum of every tick, plus a serialized WorldSnapshot every
+// KEYFRAME_INTERVAL ticks. Keyframe 0 is the state the game started from, so
+// playback never depends on what ran before, including how many players there
+// were.
+class Replay {
+public:
+    static constexpr Uint32 KEYFRAME_INTERVAL = 600;
+
+    struct Frame {
+        PlayerInputs inputs;
+        Uint8 reserved[4 - MAX_PLAYERS];
+        float deltaTime;
+    };
+
+    struct Keyframe {
+        Uint32 tick;
+        vector<Uint8> state;
+    };
+
+    void clear();
+    // The checksum is of the world as the tick starts, before it is stepped.
+    void addFrame(const PlayerInputs& inputs, float deltaTime, const WorldChecksum& checksum);
+    void addKeyframe(const World& world);
+    // Drops every frame from tick onwards and every keyframe after it, for
+    // when the world is rewound while recording.
+    void truncate(Uint32 tick);
+
+    bool saveToFile(const string& path) const;
+    bool loadFromFile(const string& path);
+
+    Uint32 getTickCount() const { return static_cast<Uint32>(frames.size()); }
+    const Frame& getFrame(Uint32 tick) const { return frames[tick]; }
+
+    // Restores the last keyframe at or before tick and steps the world
+    // headlessly up to it, checking every tick on the way. Returns false if
+    // no keyframe covers tick.
+    bool seek(World& world, Uint32 tick, FrameArena& arena);
+
+    // Compares the world with the checksum recorded for its current tick.
+    // The first divergent tick is reported with every subsystem that differs
+    // there; later ones are only counted, since everything after it differs too.
+    bool verify(const World& world);
+    Uint32 getVerifiedTicks() const { return verifiedTicks; }
+    Uint32 getMismatchCount() const { return mismatches; }
+
+private:
+    vector<Frame> frames;
+    vector<WorldChecksum> checksums;
+    vector<Keyframe> keyframes;
+    Uint32 verifiedTicks = 0;
+    Uint32 mismatches = 0;
+    // Reused by addKeyframe and seek so they do not allocate a snapshot each time.
+    mutable WorldSnapshot scratch;
+};
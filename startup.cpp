@@ -0,0 +1,117 @@
+#include "startup.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace sf;
+
+void StartupReport::beginPhase(const string& name) {
+    endPhase();
+    currentPhase = name;
+    phaseStart = now();
+}
+
+void StartupReport::endPhase() {
+    if (!currentPhase.empty()) {
+        phases.push_back({currentPhase, now() - phaseStart});
+        currentPhase.clear();
+    }
+}
+
+void StartupReport::markFirstFrame() {
+    if (firstFrameMs < 0.0f) {
+        firstFrameMs = now();
+    }
+}
+
+void StartupReport::finish() {
+    endPhase();
+    readyMs = now();
+}
+
+void StartupReport::recordAsset(const string& path, float milliseconds) {
+    lock_guard<mutex> lock(assetsMutex);
+    assets.push_back({path, milliseconds});
+}
+
+void StartupReport::print(ostream& out) const {
+    out << fixed << setprecision(2);
+    out << "startup: first frame " << firstFrameMs << " ms, ready " << readyMs << " ms" << endl;
+    for (const Entry& phase : phases) {
+        out << "  phase " << left << setw(28) << phase.name << right << setw(9) << phase.milliseconds << " ms" << endl;
+    }
+
+    vector<Entry> sorted;
+    {
+        lock_guard<mutex> lock(assetsMutex);
+        sorted = assets;
+    }
+    sort(sorted.begin(), sorted.end(),
+        [](const Entry& a, const Entry& b) { return a.milliseconds > b.milliseconds; });
+    for (const Entry& asset : sorted) {
+        out << "  asset " << left << setw(28) << asset.name << right << setw(9) << asset.milliseconds << " ms" << endl;
+    }
+}
+
+AssetPrefetcher::~AssetPrefetcher() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AssetPrefetcher::addImage(const string& path) {
+    jobs.push_back(make_unique<Job>());
+    jobs.back()->path = path;
+    jobs.back()->isSound = false;
+}
+
+void AssetPrefetcher::addSound(const string& path) {
+    jobs.push_back(make_unique<Job>());
+    jobs.back()->path = path;
+    jobs.back()->isSound = true;
+}
+
+void AssetPrefetcher::start() {
+    worker = thread(&AssetPrefetcher::run, this);
+}
+
+void AssetPrefetcher::run() {
+    for (auto& job : jobs) {
+        MemoryScope scope(job->isSound ? MemoryTag::Audio : MemoryTag::Assets);
+        bool loaded = job->isSound ? report.load(job->sound, job->path)
+                                   : report.load(job->image, job->path);
+        {
+            lock_guard<mutex> lock(jobsMutex);
+            job->loaded = loaded;
+            job->done = true;
+        }
+        jobDone.notify_all();
+    }
+}
+
+AssetPrefetcher::Job* AssetPrefetcher::waitFor(const string& path) {
+    for (auto& job : jobs) {
+        if (job->path != path) continue;
+
+        unique_lock<mutex> lock(jobsMutex);
+        jobDone.wait(lock, [&job] { return job->done; });
+        if (!job->loaded) {
+            return nullptr;
+        }
+        return job.get();
+    }
+    cerr << "Asset was not queued for prefetch: " << path << endl;
+    return nullptr;
+}
+
+const Image* AssetPrefetcher::waitForImage(const string& path) {
+    Job* job = waitFor(path);
+    return job ? &job->image : nullptr;
+}
+
+SoundBuffer* AssetPrefetcher::waitForSound(const string& path) {
+    Job* job = waitFor(path);
+    return job ? &job->sound : nullptr;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace sf;
+
+// Collects how long each startup phase and each asset load took, so the path
+// to the first visible frame can be measured rather than guessed at.
+class StartupReport {
+public:
+    void beginPhase(const string& name);
+    void markFirstFrame();
+    void finish();
+    // Safe to call from loader threads.
+    void recordAsset(const string& path, float milliseconds);
+    void print(ostream& out) const;
+
+    template <typename Asset>
+    bool load(Asset& asset, const string& path) {
+        Clock timer;
+        bool loaded = asset.loadFromFile(path);
+        recordAsset(path, timer.getElapsedTime().asMicroseconds() / 1000.0f);
+        return loaded;
+    }
+
+private:
+    struct Entry {
+        string name;
+        float milliseconds;
+    };
+
+    Clock clock;
+    vector<Entry> phases;
+    string currentPhase;
+    float phaseStart = 0.0f;
+    float firstFrameMs = -1.0f;
+    float readyMs = -1.0f;
+
+    mutable mutex assetsMutex;
+    vector<Entry> assets;
+
+    float now() const { return clock.getElapsedTime().asMicroseconds() / 1000.0f; }
+    void endPhase();
+};
+
+// Decodes images and sounds that the first screen does not need on a worker
+// thread, while the first screen is already up. Texture uploads stay on the
+// caller's thread; only the file reads and decoding move off it.
+class AssetPrefetcher {
+public:
+    explicit AssetPrefetcher(StartupReport& report) : report(report) {}
+    ~AssetPrefetcher();
+
+    void addImage(const string& path);
+    void addSound(const string& path);
+    void start();
+
+    // Block until the asset has been decoded; null if it failed to load or
+    // was never queued. The returned objects live as long as the prefetcher.
+    const Image* waitForImage(const string& path);
+    SoundBuffer* waitForSound(const string& path);
+
+private:
+    struct Job {
+        string path;
+        bool isSound;
+        bool done = false;
+        bool loaded = false;
+        Image image;
+        SoundBuffer sound;
+    };
+
+    StartupReport& report;
+    vector<unique_ptr<Job>> jobs;
+    thread worker;
+    mutex jobsMutex;
+    condition_variable jobDone;
+
+    void run();
+    Job* waitFor(const string& path);
+};
@@ -0,0 +1,720 @@
+#include "world.hpp"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+using namespace std;
+using namespace sf;
+
+static_assert(is_trivially_copyable<Player::State>::value, "snapshot records must be trivially copyable");
+static_assert(is_trivially_copyable<Bullet::State>::value, "snapshot records must be trivially copyable");
+static_assert(is_trivially_copyable<Enemy::State>::value, "snapshot records must be trivially copyable");
+static_assert(is_trivially_copyable<EnemyBullet::State>::value, "snapshot records must be trivially copyable");
+static_assert(is_trivially_copyable<Car::State>::value, "snapshot records must be trivially copyable");
+static_assert(is_trivially_copyable<Boss::State>::value, "snapshot records must be trivially copyable");
+
+namespace {
+
+template<typename T>
+void writeValue(vector<Uint8>& out, const T& value) {
+    const Uint8* bytes = reinterpret_cast<const Uint8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+void writeArray(vector<Uint8>& out, const vector<T>& values) {
+    writeValue(out, static_cast<Uint32>(values.size()));
+    const Uint8* bytes = reinterpret_cast<const Uint8*>(values.data());
+    out.insert(out.end(), bytes, bytes + values.size() * sizeof(T));
+}
+
+struct Reader {
+    const Uint8* data;
+    size_t size;
+    size_t offset = 0;
+
+    template<typename T>
+    bool read(T& value) {
+        if (size - offset < sizeof(T)) return false;
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    bool readArray(vector<T>& values) {
+        Uint32 count;
+        if (!read(count) || (size - offset) / sizeof(T) < count) return false;
+        values.resize(count);
+        memcpy(values.data(), data + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+        return true;
+    }
+};
+
+// Brings a list of live entities in line with a snapshot, reusing the
+// objects that are already there and only constructing the shortfall.
+template<typename T, typename Make>
+void restoreEntities(vector<unique_ptr<T>>& entities, const vector<typename T::State>& states, Make make) {
+    if (entities.size() > states.size()) {
+        entities.resize(states.size());
+    }
+    for (size_t i = 0; i < states.size(); i++) {
+        if (i < entities.size()) {
+            entities[i]->setState(states[i]);
+        } else {
+            entities.push_back(make(states[i]));
+        }
+    }
+}
+
+template<typename T>
+void removeInactive(vector<unique_ptr<T>>& entities) {
+    entities.erase(
+        remove_if(entities.begin(), entities.end(),
+            [](const auto& entity) { return !entity->isActive(); }),
+        entities.end()
+    );
+}
+
+bool inPlay(const Player& player) {
+    return player.getLives() > 0;
+}
+
+}
+
+bool WorldChecksum::operator==(const WorldChecksum& other) const {
+    return firstDifference(other) == PART_COUNT;
+}
+
+size_t WorldChecksum::firstDifference(const WorldChecksum& other) const {
+    for (size_t i = 0; i < PART_COUNT; i++) {
+        if (parts[i] != other.parts[i]) {
+            return i;
+        }
+    }
+    return PART_COUNT;
+}
+
+const char* WorldChecksum::partName(size_t part) {
+    switch (part) {
+        case Core: return "core";
+        case Player: return "player";
+        case Bullets: return "bullets";
+        case Enemies: return "enemies";
+        case EnemyBullets: return "enemy bullets";
+        case Cars: return "cars";
+        case PowerUps: return "power-ups";
+        case Bosses: return "bosses";
+    }
+    return "unknown";
+}
+
+void WorldSnapshot::serialize(vector<Uint8>& out) const {
+    out.clear();
+    writeValue(out, tick);
+    writeValue(out, randomState);
+    writeValue(out, enemySpawnTimer);
+    writeValue(out, carSpawnTimer);
+    writeValue(out, bossTimer);
+    writeValue(out, previousInputs);
+    writeArray(out, players);
+    writeArray(out, bullets);
+    writeArray(out, enemies);
+    writeArray(out, enemyBullets);
+    writeArray(out, cars);
+    writeArray(out, bosses);
+    writeArray(out, powerUps.posX);
+    writeArray(out, powerUps.posY);
+    writeArray(out, powerUps.types);
+    writeArray(out, powerUps.magnetized);
+}
+
+bool WorldSnapshot::deserialize(const Uint8* data, size_t size) {
+    Reader reader{data, size};
+    return reader.read(tick) && reader.read(randomState) &&
+           reader.read(enemySpawnTimer) && reader.read(carSpawnTimer) &&
+           reader.read(bossTimer) && reader.read(previousInputs) && reader.readArray(players) &&
+           reader.readArray(bullets) && reader.readArray(enemies) &&
+           reader.readArray(enemyBullets) && reader.readArray(cars) && reader.readArray(bosses) &&
+           reader.readArray(powerUps.posX) && reader.readArray(powerUps.posY) &&
+           reader.readArray(powerUps.types) && reader.readArray(powerUps.magnetized) &&
+           reader.offset == size;
+}
+
+World::World(const PlayField& field, Animator& animator, size_t playerCount, Uint64 seed)
+    : field(field), animator(animator), random(seed), powerUps(animator) {
+    playerCount = max<size_t>(1, min(playerCount, MAX_PLAYERS));
+    while (players.size() < playerCount) {
+        addPlayer();
+    }
+    for (size_t i = 0; i < players.size(); i++) {
+        players[i]->setPosition(getPlayerStart(i));
+    }
+    // Sized for a busy screen so spawning does not regrow them mid-game,
+    // with as many blocks on each kind's free list for the entities.
+    bullets.reserve(512);
+    enemies.reserve(128);
+    enemyBullets.reserve(1024);
+    cars.reserve(16);
+    bosses.reserve(4);
+    Bullet::reserve(512);
+    Enemy::reserve(128);
+    EnemyBullet::reserve(1024);
+    Car::reserve(16);
+    Boss::reserve(4);
+}
+
+void World::loadAssets() {
+    Entity::loadDeathTextures();
+    Player::loadTextures();
+    Bullet::loadTextures();
+    Enemy::loadTextures();
+    EnemyBullet::loadTextures();
+    Car::loadTextures();
+    PowerUpPool::loadTextures();
+}
+
+void World::addPlayer() {
+    players.push_back(make_unique<Player>(getPlayerStart(players.size()), field, animator));
+    if (players.size() > 1) {
+        players.back()->setTint(Color(255, 170, 170));
+    }
+}
+
+// Ships start spread evenly along the bottom of the field.
+Vector2f World::getPlayerStart(size_t index) const {
+    float spacing = field.bounds.width / (players.size() + 1);
+    return Vector2f(field.left() + spacing * (index + 1), field.bottom() - 50);
+}
+
+bool World::isGameOver() const {
+    for (const auto& player : players) {
+        if (inPlay(*player)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void World::reset() {
+    for (size_t i = 0; i < players.size(); i++) {
+        players[i]->reset(getPlayerStart(i));
+    }
+    bullets.clear();
+    enemies.clear();
+    powerUps.clear();
+    enemyBullets.clear();
+    cars.clear();
+    bosses.clear();
+    events.clear();
+    previousInputs = PlayerInputs();
+    enemySpawnTimer = 0.0f;
+    carSpawnTimer = 0.0f;
+    bossTimer = 0.0f;
+    tick = 0;
+}
+
+const WorldEffects& World::step(const PlayerInputs& inputs, float deltaTime, FrameArena& arena) {
+    effects = WorldEffects();
+
+    for (size_t i = 0; i < players.size(); i++) {
+        Player& player = *players[i];
+        if (inPlay(player) && inputs[i].has(InputState::Bomb) && !previousInputs[i].has(InputState::Bomb) &&
+            player.useBomb()) {
+            enemies.clear();
+            for (const auto& bullet : enemyBullets) {
+                powerUps.spawn(bullet->getPosition(), PowerUpPool::Type::Small, true);
+            }
+            enemyBullets.clear();
+            for (auto& boss : bosses) {
+                for (size_t part = 0; part < boss->getPartCount() && boss->isActive(); part++) {
+                    damageBoss(*boss, part, Boss::BOMB_DAMAGE, static_cast<Uint8>(i));
+                }
+            }
+        }
+    }
+    previousInputs = inputs;
+
+    if (bosses.empty()) {
+        enemySpawnTimer += deltaTime;
+        bossTimer += deltaTime;
+    }
+    carSpawnTimer += deltaTime;
+    spawn();
+    for (size_t i = 0; i < players.size(); i++) {
+        if (inPlay(*players[i])) {
+            shoot(i, inputs[i], arena);
+            players[i]->setInput(inputs[i]);
+            players[i]->update(deltaTime);
+        }
+    }
+
+    for (auto& bullet : bullets) {
+        bullet->update(deltaTime);
+        if (field.isOutOfPlay(bullet->getPosition())) {
+            bullet->setActive(false);
+        }
+    }
+
+    for (auto& enemy : enemies) {
+        enemy->update(deltaTime);
+        if (field.isOutOfPlay(enemy->getPosition())) {
+            enemy->setActive(false);
+        }
+    }
+
+    for (auto& car : cars) {
+        car->update(deltaTime);
+        if (field.isOutOfPlay(car->getPosition())) {
+            car->setActive(false);
+        }
+    }
+
+    for (auto& boss : bosses) {
+        boss->update(deltaTime);
+    }
+
+    removeInactive(bullets);
+    removeInactive(enemies);
+    removeInactive(bosses);
+
+    // The collision passes below only flag hits and push events; scoring,
+    // damage and spawns all happen when the queue is drained.
+    // Players that are invincible or out of lives cannot be hit this tick.
+    Player* targets[MAX_PLAYERS];
+    Uint8 targetIndices[MAX_PLAYERS];
+    size_t targetCount = 0;
+    for (size_t i = 0; i < players.size(); i++) {
+        if (inPlay(*players[i]) && !players[i]->isInvincible()) {
+            targets[targetCount] = players[i].get();
+            targetIndices[targetCount] = static_cast<Uint8>(i);
+            targetCount++;
+        }
+    }
+
+    for (auto& enemy : enemies) {
+        for (size_t t = 0; t < targetCount; t++) {
+            if (overlaps(targets[t]->getHitCircle(), enemy->getHitBox())) {
+                events.push({GameEvent::Type::PlayerHit, GameEvent::Source::Enemy, 0, targetIndices[t], targets[t]->getPosition()});
+            }
+        }
+        
+        for (auto& bullet : bullets) {
+            if (bullet->isActive() && enemy->isActive() && 
+                bullet->sweepHits(enemy->getHitBox())) {
+                bullet->setActive(false);
+                enemy->hit();  
+                events.push({GameEvent::Type::Kill, GameEvent::Source::None, 0, bullet->getOwner(), enemy->getPosition()});
+            }
+        }
+    }
+
+    // Only what overlaps a boss's overall box is tested against its parts.
+    for (auto& boss : bosses) {
+        HitBox bounds = boss->getHitBox();
+        for (size_t t = 0; t < targetCount; t++) {
+            HitCircle ship = targets[t]->getHitCircle();
+            if (overlaps(ship, bounds) && boss->findHit(ship) != Boss::NO_PART) {
+                events.push({GameEvent::Type::PlayerHit, GameEvent::Source::Boss, 0, targetIndices[t], targets[t]->getPosition()});
+            }
+        }
+
+        for (auto& bullet : bullets) {
+            if (!bullet->isActive() || !boss->isActive() || !overlaps(bullet->getSweptBox(), bounds)) {
+                continue;
+            }
+            size_t part = boss->findHit(*bullet);
+            if (part != Boss::NO_PART) {
+                bullet->setActive(false);
+                damageBoss(*boss, part, 1, bullet->getOwner());
+                // Destroying a part can shrink the box.
+                bounds = boss->getHitBox();
+            }
+        }
+    }
+
+    PowerUpPool::Collector collectors[MAX_PLAYERS];
+    Uint8 collectorIndices[MAX_PLAYERS];
+    size_t collectorCount = 0;
+    for (size_t i = 0; i < players.size(); i++) {
+        const Player& player = *players[i];
+        if (!inPlay(player)) continue;
+        PowerUpPool::Collector& collector = collectors[collectorCount];
+        collector.position = player.getPosition();
+        collector.collectAll = player.getPowerLevel() >= Player::MAX_POWER ||
+                               player.getPosition().y < PowerUpPool::AUTO_COLLECT_LINE;
+        collectorIndices[collectorCount] = static_cast<Uint8>(i);
+        collectorCount++;
+    }
+    powerUps.update(deltaTime, collectors, collectorCount, field);
+    for (size_t c = 0; c < collectorCount; c++) {
+        const PowerUpPool::Pickups& pickups = collectors[c].pickups;
+        for (int i = 0; i < pickups.small + pickups.large; i++) {
+            Uint8 power = i < pickups.small ? 1 : 3;
+            events.push({GameEvent::Type::Pickup, GameEvent::Source::None, power, collectorIndices[c], collectors[c].position});
+        }
+    }
+
+    // Shots are aimed at, and homing bullets steer towards, every ship still
+    // in play; unlike the hit targets this includes invincible ones.
+    Vector2f aimPoints[MAX_PLAYERS];
+    size_t aimCount = 0;
+    for (const auto& player : players) {
+        if (inPlay(*player)) {
+            aimPoints[aimCount++] = player->getPosition();
+        }
+    }
+
+    for (auto& enemy : enemies) {
+        if (enemy->canShoot() && !enemy->hasShot) {
+            effects.enemyShot = true;
+            enemy->hasShot = true;  
+            
+            for (int i = 0; i < Enemy::BURST_SIZE; i++) {
+
+                float angle = -30.0f + (60.0f * i / (Enemy::BURST_SIZE - 1));
+                float radians = angle * 3.14159f / 180.0f;
+                
+                Vector2f direction = EnemyBullet::aim(enemy->getPosition(), aimPoints, aimCount, radians);
+                
+                enemyBullets.push_back(make_unique<EnemyBullet>(
+                    enemy->getPosition(),
+                    direction * 150.0f  
+                ));
+            }
+        }
+    }
+    for (auto& boss : bosses) {
+        if (boss->isActive() && boss->fire(enemyBullets, aimPoints, aimCount) > 0) {
+            effects.enemyShot = true;
+        }
+    }
+
+    EnemyBullet::updateAll(enemyBullets, aimPoints, aimCount, field, deltaTime);
+
+    removeInactive(enemyBullets);
+
+    // The graze circle contains the hit circle, so it is the only test most
+    // bullets see; the hit test and the graze flag are only looked at inside it.
+    for (const auto& bullet : enemyBullets) {
+        HitCircle shot = bullet->getHitCircle();
+        for (size_t t = 0; t < targetCount; t++) {
+            if (!bullet->isActive() || !overlaps(targets[t]->getGrazeCircle(), shot)) {
+                continue;
+            }
+            if (overlaps(targets[t]->getHitCircle(), shot)) {
+                bullet->setActive(false);
+                events.push({GameEvent::Type::PlayerHit, GameEvent::Source::EnemyBullet, 0, targetIndices[t], targets[t]->getPosition()});
+            } else if (!bullet->isGrazedBy(targetIndices[t])) {
+                bullet->setGrazedBy(targetIndices[t]);
+                events.push({GameEvent::Type::Graze, GameEvent::Source::None, 0, targetIndices[t], shot.center});
+            }
+        }
+    }
+
+    for (const auto& car : cars) {
+        for (size_t t = 0; t < targetCount; t++) {
+            if (overlaps(targets[t]->getHitCircle(), car->getHitBox())) {
+                events.push({GameEvent::Type::PlayerHit, GameEvent::Source::Car, 0, targetIndices[t], targets[t]->getPosition()});
+            }
+        }
+    }
+
+    removeInactive(cars);
+
+    drainEvents();
+    tick++;
+    return effects;
+}
+
+void World::spawn() {
+    if (bossTimer >= BOSS_INTERVAL) {
+        bossTimer = 0;
+        float centerX = field.left() + field.bounds.width / 2;
+        bosses.push_back(make_unique<Boss>(Vector2f(centerX, field.top() - 100), field.top() + 150));
+    }
+
+    if (enemySpawnTimer >= ENEMY_SPAWN_INTERVAL) {
+        enemySpawnTimer = 0;
+        float randomX = field.left() + 50 + random.nextInt(static_cast<int>(field.bounds.width - 100));
+        enemies.push_back(make_unique<Enemy>(Vector2f(randomX, field.top() - 50), animator, random));
+    }
+
+    if (carSpawnTimer >= CAR_SPAWN_INTERVAL) {
+        carSpawnTimer = 0;
+        float randomY = field.top() + 50 + random.nextInt(static_cast<int>(field.bounds.height - 100));
+        cars.push_back(make_unique<Car>(Vector2f(field.right() + PlayField::DRAW_MARGIN, randomY)));
+    }
+}
+
+void World::shoot(size_t index, const InputState& input, FrameArena& arena) {
+    Player& player = *players[index];
+    if (!input.has(InputState::Shoot) || !player.canShoot()) {
+        return;
+    }
+    Uint8 owner = static_cast<Uint8>(index);
+    effects.shot = true;
+    
+    if (player.getIsFocused()) {
+        auto bulletPositions = player.getFocusedBulletPositions(arena);
+        for (const auto& pos : bulletPositions) {
+            bullets.push_back(make_unique<Bullet>(
+                pos,
+                Vector2f(0, -800),
+                owner
+            ));
+        }
+    } else {
+        int spreadCount = player.getSpreadCount();
+        float spreadAngle = 15.0f;
+        
+        for (int i = 0; i < spreadCount; i++) {
+            float angle = -spreadAngle * (spreadCount - 1) / 2.0f + spreadAngle * i;
+            float radians = angle * 3.14159f / 180.0f;
+            
+            Vector2f bulletVelocity(
+                -sin(radians) * 800,
+                -cos(radians) * 800
+            );
+            
+            bullets.push_back(make_unique<Bullet>(
+                player.getPosition(),
+                bulletVelocity,
+                owner
+            ));
+        }
+    }
+}
+
+// Part kills score like enemies; the core takes the rest of the boss with it.
+void World::damageBoss(Boss& boss, size_t part, int amount, Uint8 owner) {
+    if (!boss.damage(part, amount)) {
+        return;
+    }
+    if (part == Boss::CORE) {
+        boss.hit();
+        events.push({GameEvent::Type::BossDefeated, GameEvent::Source::None, 0, owner, boss.getPartPosition(part)});
+    } else {
+        events.push({GameEvent::Type::Kill, GameEvent::Source::None, 0, owner, boss.getPartPosition(part)});
+    }
+}
+
+// Consumers may push follow-up events (a pickup can cause an extend), which
+// are handled in the same drain.
+void World::drainEvents() {
+    GameEvent event;
+    while (events.pop(event)) {
+        Player& player = *players[event.player];
+        switch (event.type) {
+            case GameEvent::Type::Kill: {
+                player.addScore(100);
+                effects.enemyDeath = true;
+                PowerUpPool::Type type = (random.nextInt(100) < 80) ? 
+                    PowerUpPool::Type::Small : PowerUpPool::Type::Large;
+                powerUps.spawn(event.position, type);
+                break;
+            }
+            case GameEvent::Type::PlayerHit:
+                // Only the first hit of a tick counts; it makes the player invincible.
+                if (player.isInvincible()) {
+                    break;
+                }
+                player.hit();
+                effects.playerDeath = true;
+                player.setPosition(getPlayerStart(event.player));
+                break;
+            case GameEvent::Type::Pickup: {
+                int oldPower = player.getPowerLevel();
+                player.increasePower(event.amount);
+                player.addScore(50); 
+                effects.powerUp = true;
+                if (player.getScore() % 1500 == 0) {
+                    events.push({GameEvent::Type::Extend, GameEvent::Source::None, 0, event.player, player.getPosition()});
+                }
+                if (oldPower < Player::MAX_POWER && player.getPowerLevel() >= Player::MAX_POWER) {
+                    events.push({GameEvent::Type::FullPower, GameEvent::Source::None, 0, event.player, player.getPosition()});
+                }
+                break;
+            }
+            case GameEvent::Type::Extend:
+                player.addLife(); 
+                effects.extend = true;
+                break;
+            case GameEvent::Type::FullPower:
+                effects.fullPower = true;
+                break;
+            case GameEvent::Type::BossDefeated:
+                player.addScore(BOSS_SCORE);
+                effects.enemyDeath = true;
+                for (int i = 0; i < 16; i++) {
+                    float radians = 6.28318f * i / 16;
+                    powerUps.spawn(event.position + Vector2f(cos(radians), sin(radians)) * 40.0f,
+                                   PowerUpPool::Type::Large, true);
+                }
+                break;
+            case GameEvent::Type::Graze:
+                player.addScore(GRAZE_SCORE);
+                break;
+        }
+    }
+}
+
+void World::draw(RenderTarget& target, const DrawDetail& detail) {
+    for (const auto& player : players) {
+        // An inactive ship only has its explosion to draw.
+        if (inPlay(*player) && (player->isActive() || detail.explosions)) {
+            player->draw(target);
+        }
+        if (detail.explosions && player->isInDeathAnimation()) {
+            player->drawDeathAnimation(target);
+        }
+    }
+    for (auto& bullet : bullets) {
+        if (field.isVisible(bullet->getPosition())) {
+            bullet->draw(target);
+        }
+    }
+    for (auto& boss : bosses) {
+        boss->draw(target);
+    }
+    for (auto& enemy : enemies) {
+        if ((enemy->isActive() || (detail.explosions && enemy->isInDeathAnimation())) &&
+            field.isVisible(enemy->getPosition())) {
+            enemy->draw(target);
+        }
+    }
+    powerUps.draw(target, field, detail.powerUpSpin);
+    for (auto& bullet : enemyBullets) {
+        if (field.isVisible(bullet->getPosition())) {
+            bullet->draw(target);
+        }
+    }
+    for (auto& car : cars) {
+        if (field.isVisible(car->getPosition())) {
+            car->draw(target);
+        }
+    }
+}
+
+void World::save(WorldSnapshot& snapshot) const {
+    snapshot.tick = tick;
+    snapshot.randomState = random.getState();
+    snapshot.enemySpawnTimer = enemySpawnTimer;
+    snapshot.carSpawnTimer = carSpawnTimer;
+    snapshot.bossTimer = bossTimer;
+    snapshot.previousInputs = previousInputs;
+    snapshot.players.clear();
+    for (const auto& player : players) {
+        snapshot.players.push_back(player->getState());
+    }
+
+    snapshot.bullets.clear();
+    for (const auto& bullet : bullets) {
+        snapshot.bullets.push_back(bullet->getState());
+    }
+    snapshot.enemies.clear();
+    for (const auto& enemy : enemies) {
+        snapshot.enemies.push_back(enemy->getState());
+    }
+    snapshot.enemyBullets.clear();
+    for (const auto& bullet : enemyBullets) {
+        snapshot.enemyBullets.push_back(bullet->getState());
+    }
+    snapshot.cars.clear();
+    for (const auto& car : cars) {
+        snapshot.cars.push_back(car->getState());
+    }
+    snapshot.bosses.clear();
+    for (const auto& boss : bosses) {
+        snapshot.bosses.push_back(boss->getState());
+    }
+    powerUps.save(snapshot.powerUps);
+}
+
+WorldChecksum World::checksum() const {
+    WorldChecksum result;
+    Uint32 core = HASH_SEED;
+    core = hashValue(core, tick);
+    core = hashValue(core, random.getState());
+    core = hashValue(core, enemySpawnTimer);
+    core = hashValue(core, carSpawnTimer);
+    core = hashValue(core, bossTimer);
+    core = hashValue(core, previousInputs);
+    result.parts[WorldChecksum::Core] = core;
+
+    Uint32 hash = HASH_SEED;
+    for (const auto& player : players) {
+        hash = hashValue(hash, player->getState());
+    }
+    result.parts[WorldChecksum::Player] = hash;
+    hash = HASH_SEED;
+    for (const auto& bullet : bullets) {
+        hash = hashValue(hash, bullet->getState());
+    }
+    result.parts[WorldChecksum::Bullets] = hash;
+    hash = HASH_SEED;
+    for (const auto& enemy : enemies) {
+        hash = hashValue(hash, enemy->getState());
+    }
+    result.parts[WorldChecksum::Enemies] = hash;
+    hash = HASH_SEED;
+    for (const auto& bullet : enemyBullets) {
+        hash = hashValue(hash, bullet->getState());
+    }
+    result.parts[WorldChecksum::EnemyBullets] = hash;
+    hash = HASH_SEED;
+    for (const auto& car : cars) {
+        hash = hashValue(hash, car->getState());
+    }
+    result.parts[WorldChecksum::Cars] = hash;
+    result.parts[WorldChecksum::PowerUps] = powerUps.checksum();
+    hash = HASH_SEED;
+    for (const auto& boss : bosses) {
+        hash = hashValue(hash, boss->getState());
+    }
+    result.parts[WorldChecksum::Bosses] = hash;
+    return result;
+}
+
+void World::restore(const WorldSnapshot& snapshot) {
+    tick = snapshot.tick;
+    random.setState(snapshot.randomState);
+    enemySpawnTimer = snapshot.enemySpawnTimer;
+    carSpawnTimer = snapshot.carSpawnTimer;
+    bossTimer = snapshot.bossTimer;
+    previousInputs = snapshot.previousInputs;
+    if (players.size() > snapshot.players.size()) {
+        players.resize(snapshot.players.size());
+    }
+    while (players.size() < snapshot.players.size()) {
+        addPlayer();
+    }
+    for (size_t i = 0; i < players.size(); i++) {
+        players[i]->setState(snapshot.players[i]);
+    }
+
+    restoreEntities(bullets, snapshot.bullets, [](const Bullet::State& state) {
+        auto bullet = make_unique<Bullet>(state.entity.position, state.entity.velocity, state.owner);
+        bullet->setState(state);
+        return bullet;
+    });
+    restoreEntities(enemies, snapshot.enemies, [this](const Enemy::State& state) {
+        return make_unique<Enemy>(state, animator);
+    });
+    restoreEntities(enemyBullets, snapshot.enemyBullets, [](const EnemyBullet::State& state) {
+        auto bullet = make_unique<EnemyBullet>(state.entity.position, state.entity.velocity);
+        bullet->setState(state);
+        return bullet;
+    });
+    restoreEntities(cars, snapshot.cars, [](const Car::State& state) {
+        auto car = make_unique<Car>(state.position);
+        car->setState(state);
+        return car;
+    });
+    restoreEntities(bosses, snapshot.bosses, [](const Boss::State& state) {
+        return make_unique<Boss>(state);
+    });
+    powerUps.restore(snapshot.powerUps);
+    events.clear();
+}
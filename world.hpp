@@ -0,0 +1,153 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <memory>
+#include <vector>
+#include "entities.hpp"
+#include "events.hpp"
+#include "arena.hpp"
+#include "random.hpp"
+
+using namespace std;
+using namespace sf;
+
+// Co-op runs a second ship; every per-tick input is one InputState per player.
+constexpr size_t MAX_PLAYERS = 2;
+using PlayerInputs = array<InputState, MAX_PLAYERS>;
+
+// Cosmetic work draw() can leave out when frames run long. None of it is
+// simulated, so skipping it changes nothing a replay or checksum sees.
+struct DrawDetail {
+    bool explosions = true;
+    bool powerUpSpin = true;
+};
+
+// What the presentation side (audio, HUD effects) should react to after a
+// tick. The simulation has already applied score, damage and spawns.
+struct WorldEffects {
+    bool shot = false;
+    bool enemyShot = false;
+    bool enemyDeath = false;
+    bool playerDeath = false;
+    bool powerUp = false;
+    bool extend = false;
+    bool fullPower = false;
+};
+
+// Per-subsystem hashes of the world state, cheap enough to take every tick.
+// Comparing them part by part says which subsystem diverged first.
+struct WorldChecksum {
+    enum Part {
+        Core,
+        Player,
+        Bullets,
+        Enemies,
+        EnemyBullets,
+        Cars,
+        PowerUps,
+        Bosses
+    };
+    static const size_t PART_COUNT = 8;
+
+    Uint32 parts[PART_COUNT] = {};
+
+    bool operator==(const WorldChecksum& other) const;
+    bool operator!=(const WorldChecksum& other) const { return !(*this == other); }
+    // The first part that differs, or PART_COUNT if none do.
+    size_t firstDifference(const WorldChecksum& other) const;
+    static const char* partName(size_t part);
+};
+
+// Everything a tick depends on, as flat arrays of trivially copyable records.
+// Saving into an existing snapshot reuses its capacity.
+struct WorldSnapshot {
+    Uint32 tick = 0;
+    Uint64 randomState = 0;
+    float enemySpawnTimer = 0.0f;
+    float carSpawnTimer = 0.0f;
+    float bossTimer = 0.0f;
+    PlayerInputs previousInputs = {};
+    vector<Player::State> players;
+    vector<Bullet::State> bullets;
+    vector<Enemy::State> enemies;
+    vector<EnemyBullet::State> enemyBullets;
+    vector<Car::State> cars;
+    vector<Boss::State> bosses;
+    PowerUpPool::State powerUps;
+
+    void serialize(vector<Uint8>& out) const;
+    bool deserialize(const Uint8* data, size_t size);
+};
+
+// The game simulation: the players, every entity list, spawn timers and the
+// random generator. main feeds it one InputState per player per tick and
+// draws it. Inputs for players beyond getPlayerCount() are ignored.
+class World {
+public:
+    static constexpr float ENEMY_SPAWN_INTERVAL = 0.5f;
+    static constexpr float CAR_SPAWN_INTERVAL = 2.0f;
+    // Seconds of regular waves between bosses. Waves hold off while one is up.
+    static constexpr float BOSS_INTERVAL = 60.0f;
+    static constexpr int BOSS_SCORE = 10000;
+    // Once per bullet per player, however long it stays close.
+    static constexpr int GRAZE_SCORE = 10;
+    static constexpr Uint64 DEFAULT_SEED = 1;
+
+    World(const PlayField& field, Animator& animator, size_t playerCount = 1, Uint64 seed = DEFAULT_SEED);
+    // Loads the art every kind of entity shares. Worlds load what they need
+    // on first use anyway; this just keeps the disk reads out of the game.
+    static void loadAssets();
+
+    // Starts a new game. The random sequence carries on rather than repeating.
+    void reset();
+    const WorldEffects& step(const PlayerInputs& inputs, float deltaTime, FrameArena& arena);
+    // Draws the play field contents; the caller sets up the game view.
+    void draw(RenderTarget& target, const DrawDetail& detail = DrawDetail());
+
+    void save(WorldSnapshot& snapshot) const;
+    // Restoring also brings the player count in line with the snapshot.
+    void restore(const WorldSnapshot& snapshot);
+    // Hashes the same fields a snapshot saves, without building one.
+    WorldChecksum checksum() const;
+
+    size_t getPlayerCount() const { return players.size(); }
+    const Player& getPlayer(size_t index = 0) const { return *players[index]; }
+    Vector2f getPlayerStart(size_t index = 0) const;
+    // A player out of lives stops playing; the game is over once all are.
+    bool isGameOver() const;
+    // Read-only views for code that plays or inspects the game from outside.
+    const PlayField& getField() const { return field; }
+    const vector<unique_ptr<Enemy>>& getEnemies() const { return enemies; }
+    const vector<unique_ptr<EnemyBullet>>& getEnemyBullets() const { return enemyBullets; }
+    const vector<unique_ptr<Car>>& getCars() const { return cars; }
+    const vector<unique_ptr<Boss>>& getBosses() const { return bosses; }
+    size_t getBulletCount() const { return bullets.size(); }
+    size_t getPowerUpCount() const { return powerUps.size(); }
+    Uint32 getTick() const { return tick; }
+    size_t getDroppedEvents() const { return events.getDropped(); }
+
+private:
+    PlayField field;
+    Animator& animator;
+    Random random;
+    vector<unique_ptr<Player>> players;
+    vector<unique_ptr<Bullet>> bullets;
+    vector<unique_ptr<Enemy>> enemies;
+    PowerUpPool powerUps;
+    vector<unique_ptr<EnemyBullet>> enemyBullets;
+    vector<unique_ptr<Car>> cars;
+    vector<unique_ptr<Boss>> bosses;
+    EventQueue events;
+    WorldEffects effects;
+    PlayerInputs previousInputs = {};
+    float enemySpawnTimer = 0.0f;
+    float carSpawnTimer = 0.0f;
+    float bossTimer = 0.0f;
+    Uint32 tick = 0;
+
+    void addPlayer();
+    void spawn();
+    void shoot(size_t index, const InputState& input, FrameArena& arena);
+    void damageBoss(Boss& boss, size_t part, int amount, Uint8 owner);
+    void drainEvents();
+};